@@ -31,11 +31,14 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <stdexcept>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace lru {
 /*
@@ -210,6 +213,114 @@ private:
     size_t elasticity_;
 };
 
+/**
+ * A thread-safe LRU cache split into independent shards by key hash, each a
+ * Cache with its own mutex, so that threads accessing different shards do not
+ * contend. The capacity is split evenly over the shards, and each shard evicts
+ * its own least recently used keys, so the eviction order is LRU per shard and
+ * only approximately LRU over the whole cache.
+ */
+template <class Key, class Value, class Hash = std::hash<Key>>
+class ShardedCache {
+public:
+    typedef Cache<Key, Value, std::mutex,
+                  std::unordered_map<
+                      Key,
+                      typename std::list<KeyValuePair<Key, Value>>::iterator,
+                      Hash>>
+        shard_type;
+
+    /**
+     * shards is rounded up to a power of two; if 0, it is four times the
+     * number of hardware threads. A bounded cache has at most maxSize shards
+     * (rounded down to a power of two), whose capacities and elasticities add
+     * up to maxSize and elasticity.
+     */
+    explicit ShardedCache(size_t maxSize = 64, size_t elasticity = 10,
+                          size_t shards = 0)
+        : maxSize_(maxSize), elasticity_(elasticity) {
+        if (shards == 0)
+            shards = 4 * std::max(1u, std::thread::hardware_concurrency());
+        while ((size_t(1) << bits_) < shards) bits_++;
+        // a shard of capacity 0 would be unbounded
+        while (maxSize > 0 && (size_t(1) << bits_) > maxSize) bits_--;
+        shards = size_t(1) << bits_;
+        for (size_t i = 0; i < shards; i++)
+            shards_.emplace_back(
+                new shard_type(maxSize / shards + (i < maxSize % shards),
+                               elasticity / shards + (i < elasticity % shards)));
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (auto& shard : shards_) n += shard->size();
+        return n;
+    }
+
+    bool empty() const {
+        for (auto& shard : shards_)
+            if (!shard->empty()) return false;
+        return true;
+    }
+
+    void clear() {
+        for (auto& shard : shards_) shard->clear();
+    }
+
+    void insert(const Key& k, const Value& v) { getShard(k).insert(k, v); }
+
+    bool tryGet(const Key& kIn, Value& vOut) {
+        return getShard(kIn).tryGet(kIn, vOut);
+    }
+
+    /**
+     * Unlike Cache::get(), a copy is returned, as other threads may evict the
+     * key at any time.
+     */
+    Value get(const Key& k) { return getShard(k).getCopy(k); }
+
+    Value getCopy(const Key& k) { return get(k); }
+
+    bool remove(const Key& k) { return getShard(k).remove(k); }
+
+    bool contains(const Key& k) { return getShard(k).contains(k); }
+
+    size_t getMaxSize() const { return maxSize_; }
+    size_t getElasticity() const { return elasticity_; }
+    size_t getMaxAllowedSize() const { return maxSize_ + elasticity_; }
+    size_t getShards() const { return shards_.size(); }
+
+    /**
+     * Walk the shards one by one, each in LRU order.
+     */
+    template <typename F>
+    void cwalk(F& f) const {
+        for (auto& shard : shards_) shard->cwalk(f);
+    }
+
+private:
+    // Dissallow copying.
+    ShardedCache(const ShardedCache&) = delete;
+    ShardedCache& operator=(const ShardedCache&) = delete;
+
+    /**
+     * Shards are chosen by the high bits of the mixed hash, since the map in
+     * a shard uses the low bits of the same hash, and std::hash of integers
+     * is the identity.
+     */
+    shard_type& getShard(const Key& k) const {
+        if (bits_ == 0) return *shards_[0];
+        uint64_t h = (uint64_t)hash_(k) * 0x9E3779B97F4A7C15ULL;
+        return *shards_[h >> (64 - bits_)];
+    }
+
+    std::vector<std::unique_ptr<shard_type>> shards_;
+    Hash hash_;
+    int bits_ = 0;
+    size_t maxSize_;
+    size_t elasticity_;
+};
+
 }  // namespace lru
 
 #endif /* __LRUCACHE_H__ */
@@ -0,0 +1,280 @@
+#ifndef __CLOCK_CACHE_H__
+#define __CLOCK_CACHE_H__
+// A thread-safe cache with CLOCK eviction, in which hits do not lock.
+//
+// Entries are stored in an open-addressing (linear probing) table of at least
+// twice the capacity. Each slot has a sequence number, which writers make odd
+// while changing the slot, and readers check before and after copying the
+// slot, retrying if it changed (a seqlock). A hit only sets the reference bit
+// of the slot, and only if it is not set yet, so hot entries are read without
+// writing shared memory. Inserts and removes take a mutex. When the cache is
+// full, the clock hand sweeps the slots, clearing reference bits, and evicts
+// the first entry whose bit is clear.
+//
+// Since slots are copied word by word, keys and values must be trivially
+// copyable, and keys are compared bitwise, so they must not have padding. A
+// lookup running concurrently with a remove or an eviction may miss a key
+// that is being moved in the table, which is a harmless cache miss.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "LRUCache.h"
+
+namespace lru {
+
+template <class Key, class Value, class Hash = std::hash<Key>>
+class ClockCache {
+    static_assert(std::is_trivially_copyable<Key>::value &&
+                      std::has_unique_object_representations<Key>::value,
+                  "keys must be trivially copyable without padding");
+    static_assert(std::is_trivially_copyable<Value>::value,
+                  "values must be trivially copyable");
+
+private:
+    static constexpr int KEY_WORDS = (sizeof(Key) + 7) / 8;
+    static constexpr int VAL_WORDS = (sizeof(Value) + 7) / 8;
+
+    struct Slot {
+        std::atomic<uint32_t> seq{0};  // odd while being written
+        std::atomic<uint8_t> full{0};
+        std::atomic<uint8_t> ref{0};
+        std::atomic<uint64_t> key[KEY_WORDS];
+        std::atomic<uint64_t> val[VAL_WORDS];
+    };
+
+    // an entry copied out of a slot
+    struct Entry {
+        bool full = false;
+        uint8_t ref = 0;
+        uint64_t key[KEY_WORDS] = {}, val[VAL_WORDS] = {};
+    };
+
+    size_t maxSize_;
+    int bits_;
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    // home slot of the entry in each slot; only used by writers
+    std::vector<uint32_t> homes_;
+    std::atomic<size_t> size_{0};
+    size_t hand_ = 0;
+    Hash hash_;
+    mutable std::mutex lock_;
+
+private:
+    static void encode(const Key& k, uint64_t* words) {
+        words[KEY_WORDS - 1] = 0;
+        std::memcpy(words, &k, sizeof(Key));
+    }
+
+    size_t getHome(const uint64_t h) const {
+        return (h * 0x9E3779B97F4A7C15ULL) >> (64 - bits_);
+    }
+
+    /**
+     * Copy slot i consistently, waiting while it is being written.
+     */
+    void read(const size_t i, Entry& e, const bool with_val) const {
+        const Slot& slot = slots_[i];
+        while (true) {
+            uint32_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            e.full = slot.full.load(std::memory_order_relaxed);
+            for (int w = 0; w < KEY_WORDS; w++)
+                e.key[w] = slot.key[w].load(std::memory_order_relaxed);
+            if (with_val)
+                for (int w = 0; w < VAL_WORDS; w++)
+                    e.val[w] = slot.val[w].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == seq) return;
+        }
+    }
+
+    /**
+     * Overwrite slot i with e. Writers only.
+     */
+    void write(const size_t i, const Entry& e) {
+        Slot& slot = slots_[i];
+        uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.full.store(e.full, std::memory_order_relaxed);
+        slot.ref.store(e.ref, std::memory_order_relaxed);
+        for (int w = 0; w < KEY_WORDS; w++)
+            slot.key[w].store(e.key[w], std::memory_order_relaxed);
+        for (int w = 0; w < VAL_WORDS; w++)
+            slot.val[w].store(e.val[w], std::memory_order_relaxed);
+        slot.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * Probe for the key. Return its slot, or the first empty slot if absent
+     * (with found = false).
+     */
+    size_t find(const uint64_t* key, const size_t home, bool& found,
+                const bool with_val, Entry& e) const {
+        for (size_t i = home;; i = (i + 1) & mask_) {
+            read(i, e, with_val);
+            if (!e.full || std::memcmp(e.key, key, sizeof(e.key)) == 0) {
+                found = e.full;
+                return i;
+            }
+        }
+    }
+
+    /**
+     * Empty slot i, moving back later entries of the probe sequence so that
+     * no tombstone is needed. Writers only.
+     */
+    void erase(size_t i) {
+        Entry e;
+        for (size_t j = (i + 1) & mask_;; j = (j + 1) & mask_) {
+            if (!slots_[j].full.load(std::memory_order_relaxed)) break;
+            // the entry at j may move to i if i is in its probe sequence
+            size_t home = homes_[j];
+            if (((j - home) & mask_) < ((j - i) & mask_)) continue;
+            read(j, e, true);
+            e.ref = slots_[j].ref.load(std::memory_order_relaxed);
+            write(i, e);
+            homes_[i] = home;
+            i = j;
+        }
+        write(i, Entry());
+        size_--;
+    }
+
+    /**
+     * Evict an entry whose reference bit is clear. Writers only.
+     */
+    void evict() {
+        while (true) {
+            Slot& slot = slots_[hand_];
+            if (slot.full.load(std::memory_order_relaxed)) {
+                if (slot.ref.load(std::memory_order_relaxed) == 0) {
+                    // the hand stays: a later entry may be moved here
+                    erase(hand_);
+                    return;
+                }
+                slot.ref.store(0, std::memory_order_relaxed);
+            }
+            hand_ = (hand_ + 1) & mask_;
+        }
+    }
+
+public:
+    explicit ClockCache(size_t maxSize = 64)
+        : maxSize_(std::max<size_t>(1, maxSize)), bits_(1) {
+        while ((size_t(1) << bits_) < 2 * maxSize_) bits_++;
+        mask_ = (size_t(1) << bits_) - 1;
+        slots_.reset(new Slot[mask_ + 1]);
+        homes_.resize(mask_ + 1);
+        for (size_t i = 0; i <= mask_; i++) write(i, Entry());
+    }
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    bool empty() const { return size() == 0; }
+
+    void clear() {
+        std::lock_guard<std::mutex> g(lock_);
+        for (size_t i = 0; i <= mask_; i++)
+            if (slots_[i].full.load(std::memory_order_relaxed))
+                write(i, Entry());
+        size_ = 0;
+        hand_ = 0;
+    }
+
+    void insert(const Key& k, const Value& v) {
+        Entry e;
+        uint64_t key[KEY_WORDS];
+        encode(k, key);
+        size_t home = getHome(hash_(k));
+        bool found;
+        std::lock_guard<std::mutex> g(lock_);
+        size_t i = find(key, home, found, false, e);
+        if (!found && size_ >= maxSize_) {
+            evict();
+            i = find(key, home, found, false, e);
+        }
+        std::memcpy(e.key, key, sizeof(key));
+        e.val[VAL_WORDS - 1] = 0;
+        std::memcpy(e.val, &v, sizeof(Value));
+        e.full = true;
+        // new entries start unreferenced, so that keys used once are evicted
+        // at the next sweep
+        e.ref = found;
+        write(i, e);
+        homes_[i] = home;
+        if (!found) size_++;
+    }
+
+    /**
+     * Lock-free lookup.
+     */
+    bool tryGet(const Key& kIn, Value& vOut) const {
+        Entry e;
+        uint64_t key[KEY_WORDS];
+        encode(kIn, key);
+        bool found;
+        size_t i = find(key, getHome(hash_(kIn)), found, true, e);
+        if (!found) return false;
+        std::memcpy(&vOut, e.val, sizeof(Value));
+        if (slots_[i].ref.load(std::memory_order_relaxed) == 0)
+            slots_[i].ref.store(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Returns a copy, as other threads may evict the key at any time.
+     */
+    Value get(const Key& k) const {
+        Value v;
+        if (!tryGet(k, v)) throw KeyNotFound();
+        return v;
+    }
+
+    bool remove(const Key& k) {
+        Entry e;
+        uint64_t key[KEY_WORDS];
+        encode(k, key);
+        bool found;
+        std::lock_guard<std::mutex> g(lock_);
+        size_t i = find(key, getHome(hash_(k)), found, false, e);
+        if (found) erase(i);
+        return found;
+    }
+
+    /**
+     * Lock-free; the reference bit is not set.
+     */
+    bool contains(const Key& k) const {
+        Entry e;
+        uint64_t key[KEY_WORDS];
+        encode(k, key);
+        bool found;
+        find(key, getHome(hash_(k)), found, false, e);
+        return found;
+    }
+
+    size_t getMaxSize() const { return maxSize_; }
+
+private:
+    // Dissallow copying.
+    ClockCache(const ClockCache&) = delete;
+    ClockCache& operator=(const ClockCache&) = delete;
+};
+
+}  // namespace lru
+
+#endif /* __CLOCK_CACHE_H__ */
@@ -0,0 +1,329 @@
+#ifndef __LOCKFREE_QUEUE_H__
+#define __LOCKFREE_QUEUE_H__
+// Bounded lock-free queues, alternatives to SynQueue for small items:
+//
+// - MPMCQueue: multi-producer multi-consumer ring buffer with a sequence
+//   number per cell, after D. Vyukov's bounded MPMC queue.
+// - SPSCQueue: single-producer single-consumer ring buffer; push and pop are
+//   wait-free.
+//
+// try*() never block. push*() and pop*() spin for a while, then park the
+// thread on a condition variable, which the other side only touches when a
+// thread is parked. Capacities are rounded up to powers of two.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace syn {
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/**
+ * Parks threads until a condition may hold. notify() costs a fence and a load
+ * when no thread is parked.
+ */
+class Parker {
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::atomic<int> waiters_{0};
+
+public:
+    /**
+     * Block until ready() returns true. ready() is checked under the lock
+     * after registering as a waiter, so a notify() after the condition
+     * becomes true is not missed.
+     */
+    template <class Ready>
+    void wait(Ready ready) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cond_.wait(lock, ready);
+        waiters_.fetch_sub(1);
+    }
+
+    void notify(const bool all = false) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0) return;
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        if (all)
+            cond_.notify_all();
+        else
+            cond_.notify_one();
+    }
+};
+
+/**
+ * Retry op() until it succeeds, spinning first and then parking until ready().
+ */
+template <class Op, class Ready>
+void spinThenPark(Parker& parker, Op op, Ready ready) {
+    static const int SPINS = 128;
+    for (int i = 0; i < SPINS; i++) {
+        if (op()) return;
+        cpuRelax();
+    }
+    while (!op()) parker.wait(ready);
+}
+
+inline size_t roundUpPow2(const size_t n) {
+    size_t cap = 2;
+    while (cap < n) cap <<= 1;
+    return cap;
+}
+
+template <typename T>
+class MPMCQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    alignas(64) Parker producers_, consumers_;
+
+private:
+    /**
+     * Claim up to n cells starting from the enqueue (or dequeue) position,
+     * where a cell at position pos is ready if its sequence number is pos +
+     * lag. Return the first position and set n to the number claimed, which
+     * is 0 if none is ready.
+     */
+    size_t claim(std::atomic<size_t>& at, const size_t lag, size_t& n) {
+        size_t pos = at.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t k = 0;
+            while (k < n && cells_[(pos + k) & mask_].seq.load(
+                                std::memory_order_acquire) == pos + k + lag)
+                k++;
+            if (k == 0) {
+                size_t seq = cells_[pos & mask_].seq.load(
+                    std::memory_order_acquire);
+                // the cell is behind: queue full (or empty)
+                if ((intptr_t)(seq - (pos + lag)) < 0) {
+                    n = 0;
+                    return pos;
+                }
+                pos = at.load(std::memory_order_relaxed);
+            } else if (at.compare_exchange_weak(pos, pos + k,
+                                                std::memory_order_relaxed)) {
+                n = k;
+                return pos;
+            }
+        }
+    }
+
+    bool canPush() const {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        return cells_[pos & mask_].seq.load(std::memory_order_acquire) == pos;
+    }
+
+    bool canPop() const {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        return cells_[pos & mask_].seq.load(std::memory_order_acquire) ==
+               pos + 1;
+    }
+
+public:
+    MPMCQueue(const size_t capacity = 1024)
+        : mask_(roundUpPow2(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; i++)
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    /**
+     * Push at most n items. Return the number of items pushed.
+     */
+    size_t tryPushN(const T* items, size_t n) {
+        size_t pos = claim(enqueue_pos_, 0, n);
+        for (size_t i = 0; i < n; i++) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            cell.data = items[i];
+            cell.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        if (n > 0) consumers_.notify(n > 1);
+        return n;
+    }
+
+    /**
+     * Pop at most n items into out. Return the number of items popped.
+     */
+    size_t tryPopN(T* out, size_t n) {
+        size_t pos = claim(dequeue_pos_, 1, n);
+        for (size_t i = 0; i < n; i++) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            out[i] = std::move(cell.data);
+            cell.seq.store(pos + i + mask_ + 1, std::memory_order_release);
+        }
+        if (n > 0) producers_.notify(n > 1);
+        return n;
+    }
+
+    bool tryPush(const T& item) { return tryPushN(&item, 1) == 1; }
+    bool tryPop(T& item) { return tryPopN(&item, 1) == 1; }
+
+    void push(const T& item) {
+        spinThenPark(
+            producers_, [&] { return tryPush(item); },
+            [this] { return canPush(); });
+    }
+
+    void pop(T& item) {
+        spinThenPark(
+            consumers_, [&] { return tryPop(item); },
+            [this] { return canPop(); });
+    }
+
+    /**
+     * Push all n items, blocking while the queue is full.
+     */
+    void pushN(const T* items, const size_t n) {
+        size_t done = 0;
+        while (done < n)
+            spinThenPark(
+                producers_,
+                [&] {
+                    size_t k = tryPushN(items + done, n - done);
+                    done += k;
+                    return k > 0;
+                },
+                [this] { return canPush(); });
+    }
+
+    /**
+     * Pop at least one and at most n items, blocking while the queue is empty.
+     * Return the number of items popped.
+     */
+    size_t popN(T* out, const size_t n) {
+        size_t k = 0;
+        spinThenPark(
+            consumers_, [&] { return (k = tryPopN(out, n)) > 0; },
+            [this] { return canPop(); });
+        return k;
+    }
+
+    /**
+     * Approximate number of items.
+     */
+    size_t getSize() const {
+        size_t e = enqueue_pos_.load(std::memory_order_relaxed),
+               d = dequeue_pos_.load(std::memory_order_relaxed);
+        return e > d ? e - d : 0;
+    }
+};
+
+template <typename T>
+class SPSCQueue {
+private:
+    const size_t mask_;
+    std::unique_ptr<T[]> buf_;
+    // positions only grow; each side caches the other's position
+    alignas(64) std::atomic<size_t> head_{0};  // next to pop
+    size_t tail_cache_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};  // next to push
+    size_t head_cache_ = 0;
+    alignas(64) Parker producer_, consumer_;
+
+public:
+    SPSCQueue(const size_t capacity = 1024)
+        : mask_(roundUpPow2(capacity) - 1), buf_(new T[mask_ + 1]) {}
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    /**
+     * Push at most n items. Producer only.
+     */
+    size_t tryPushN(const T* items, size_t n) {
+        size_t t = tail_.load(std::memory_order_relaxed);
+        if (t - head_cache_ + n > mask_ + 1)
+            head_cache_ = head_.load(std::memory_order_acquire);
+        n = std::min(n, mask_ + 1 - (t - head_cache_));
+        for (size_t i = 0; i < n; i++) buf_[(t + i) & mask_] = items[i];
+        if (n > 0) {
+            tail_.store(t + n, std::memory_order_release);
+            consumer_.notify();
+        }
+        return n;
+    }
+
+    /**
+     * Pop at most n items into out. Consumer only.
+     */
+    size_t tryPopN(T* out, size_t n) {
+        size_t h = head_.load(std::memory_order_relaxed);
+        if (tail_cache_ - h < n)
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+        n = std::min(n, tail_cache_ - h);
+        for (size_t i = 0; i < n; i++)
+            out[i] = std::move(buf_[(h + i) & mask_]);
+        if (n > 0) {
+            head_.store(h + n, std::memory_order_release);
+            producer_.notify();
+        }
+        return n;
+    }
+
+    bool tryPush(const T& item) { return tryPushN(&item, 1) == 1; }
+    bool tryPop(T& item) { return tryPopN(&item, 1) == 1; }
+
+    void push(const T& item) {
+        spinThenPark(
+            producer_, [&] { return tryPush(item); },
+            [this] { return tail_.load() - head_.load() <= mask_; });
+    }
+
+    void pop(T& item) {
+        spinThenPark(
+            consumer_, [&] { return tryPop(item); },
+            [this] { return tail_.load() != head_.load(); });
+    }
+
+    void pushN(const T* items, const size_t n) {
+        size_t done = 0;
+        while (done < n)
+            spinThenPark(
+                producer_,
+                [&] {
+                    size_t k = tryPushN(items + done, n - done);
+                    done += k;
+                    return k > 0;
+                },
+                [this] { return tail_.load() - head_.load() <= mask_; });
+    }
+
+    size_t popN(T* out, const size_t n) {
+        size_t k = 0;
+        spinThenPark(
+            consumer_, [&] { return (k = tryPopN(out, n)) > 0; },
+            [this] { return tail_.load() != head_.load(); });
+        return k;
+    }
+
+    size_t getSize() const { return tail_.load() - head_.load(); }
+};
+
+}  // namespace syn
+
+#endif
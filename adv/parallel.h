@@ -0,0 +1,194 @@
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+// Parallel loops over index or random-access iterator ranges on a thread pool
+// (ThreadPool or WorkStealingPool). The range is cut into chunks of `grain`
+// items (automatic if grain <= 0). A call posts at most one job per pool
+// thread; jobs and the calling thread claim chunks from a shared counter, and
+// the caller returns when all chunks are done. No future is created per chunk,
+// and since the caller also runs chunks, loops may be nested in pool jobs. If
+// the body throws, the chunks not started yet are skipped, and the first
+// exception is rethrown to the caller once the running chunks are done.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "work_stealing_pool.h"
+
+namespace syn {
+
+/**
+ * The pool used by the functions without a pool argument, with one thread per
+ * hardware thread.
+ */
+inline WorkStealingPool& defaultPool() {
+    static WorkStealingPool pool(
+        std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+/**
+ * Chunk size for n items: grain if positive, otherwise about four chunks per
+ * thread.
+ */
+template <class Pool>
+long getGrain(const Pool& pool, const long n, const long grain) {
+    if (grain > 0) return grain;
+    return std::max(1L, n / (std::max<long>(1, pool.size()) * 4));
+}
+
+/**
+ * Run body(chunk, lo, hi) for chunks [lo, hi) of [begin, end), where chunk is
+ * the index of the chunk.
+ */
+template <class Pool, class Index, class F>
+void parallel_chunks(Pool& pool, const Index begin, const Index end,
+                     long grain, F&& body) {
+    const long n = end - begin;
+    if (n <= 0) return;
+    const long threads = std::max<long>(1, pool.size());
+    grain = getGrain(pool, n, grain);
+    const long num_chunks = (n + grain - 1) / grain;
+    if (num_chunks == 1 || threads == 1) {
+        for (long c = 0; c < num_chunks; c++)
+            body(c, begin + c * grain, begin + std::min(n, (c + 1) * grain));
+        return;
+    }
+
+    struct State {
+        std::atomic<long> next{0}, done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::exception_ptr error;  // the first exception of body
+    };
+    // jobs may start after the loop is done, so they share the state
+    auto state = std::make_shared<State>();
+    // claim and run chunks until none is left
+    auto work = [state, &body, begin, n, grain, num_chunks]() {
+        long c, finished = 0;
+        while ((c = state->next.fetch_add(1)) < num_chunks) {
+            finished++;
+            try {
+                body(c, begin + c * grain,
+                     begin + std::min(n, (c + 1) * grain));
+            } catch (...) {
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->error) state->error = std::current_exception();
+                }
+                // claim the chunks left, which count as done without running
+                long left = state->next.exchange(num_chunks);
+                if (left < num_chunks) finished += num_chunks - left;
+            }
+        }
+        if (finished > 0 && state->done.fetch_add(finished) + finished ==
+                                num_chunks) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->cv.notify_one();
+        }
+    };
+    for (long j = 1; j < std::min(threads, num_chunks); j++) pool.post(work);
+    work();
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done.load() == num_chunks; });
+    // take the exception, as a pool job may free the state
+    std::exception_ptr err = std::move(state->error);
+    if (err) std::rethrow_exception(err);
+}
+
+/**
+ * Run fn(i) for each i in [begin, end).
+ */
+template <class Pool, class Index, class F>
+void parallel_for(Pool& pool, const Index begin, const Index end,
+                  const long grain, F&& fn) {
+    parallel_chunks(pool, begin, end, grain,
+                    [&fn](long, Index lo, const Index hi) {
+                        for (; lo != hi; ++lo) fn(lo);
+                    });
+}
+
+template <class Index, class F>
+void parallel_for(const Index begin, const Index end, const long grain,
+                  F&& fn) {
+    parallel_for(defaultPool(), begin, end, grain, std::forward<F>(fn));
+}
+
+/**
+ * Return reduce(... reduce(reduce(init, map(begin)), map(begin + 1)) ...,
+ * map(end - 1)), where reduce is associative and init is its identity.
+ * Partial results of chunks are combined in order, so the result does not
+ * depend on the number of threads.
+ */
+template <class Pool, class Index, class T, class Map, class Reduce>
+T parallel_reduce(Pool& pool, const Index begin, const Index end, long grain,
+                  const T& init, Map&& map, Reduce&& reduce) {
+    const long n = std::max(0L, (long)(end - begin));
+    grain = getGrain(pool, n, grain);
+    std::vector<T> partial((n + grain - 1) / grain, init);
+    parallel_chunks(pool, begin, end, grain,
+                    [&](long c, Index lo, const Index hi) {
+                        T acc = init;
+                        for (; lo != hi; ++lo) acc = reduce(acc, map(lo));
+                        partial[c] = std::move(acc);
+                    });
+    T res = init;
+    for (auto& acc : partial) res = reduce(res, acc);
+    return res;
+}
+
+template <class Index, class T, class Map, class Reduce>
+T parallel_reduce(const Index begin, const Index end, const long grain,
+                  const T& init, Map&& map, Reduce&& reduce) {
+    return parallel_reduce(defaultPool(), begin, end, grain, init,
+                           std::forward<Map>(map),
+                           std::forward<Reduce>(reduce));
+}
+
+/**
+ * Inclusive scan: out[i] = op(in[0], ..., in[i]) for random-access iterators
+ * in and out, where op is associative and init is its identity. out may be
+ * in. Each item is read twice, once to sum chunks and once to scan them.
+ */
+template <class Pool, class InIt, class OutIt, class T, class Op>
+void parallel_scan(Pool& pool, const InIt first, const InIt last,
+                   const OutIt out, long grain, const T& init, Op&& op) {
+    const long n = std::max(0L, (long)(last - first));
+    grain = getGrain(pool, n, grain);
+    std::vector<T> sums((n + grain - 1) / grain, init);
+    parallel_chunks(pool, first, last, grain,
+                    [&](long c, InIt lo, const InIt hi) {
+                        T acc = init;
+                        for (; lo != hi; ++lo) acc = op(acc, *lo);
+                        sums[c] = std::move(acc);
+                    });
+    // offsets of chunks, i.e., exclusive scan of chunk sums
+    T acc = init;
+    for (auto& sum : sums) {
+        T tmp = op(acc, sum);
+        sum = std::move(acc);
+        acc = std::move(tmp);
+    }
+    parallel_chunks(pool, first, last, grain,
+                    [&](long c, InIt lo, const InIt hi) {
+                        T acc = sums[c];
+                        OutIt o = out + (lo - first);
+                        for (; lo != hi; ++lo, ++o) *o = acc = op(acc, *lo);
+                    });
+}
+
+template <class InIt, class OutIt, class T, class Op>
+void parallel_scan(const InIt first, const InIt last, const OutIt out,
+                   const long grain, const T& init, Op&& op) {
+    parallel_scan(defaultPool(), first, last, out, grain, init,
+                  std::forward<Op>(op));
+}
+
+}  // namespace syn
+
+#endif
@@ -0,0 +1,303 @@
+#ifndef __PIPELINE_H__
+#define __PIPELINE_H__
+// A pipeline of stages connected by bounded queues, e.g.,
+//
+//     syn::Pipeline pipe(8);
+//     pipe.source<std::string>("read", [&](std::string& block) { ... })
+//         .then("parse", 4, [](std::string& block) { return parse(block); })
+//         .sink("build", [&](std::vector<Edge>& edges) { ... });
+//     pipe.wait();
+//     pipe.printStats();
+//
+// The source runs in one thread and returns false at the end of input. Each
+// stage maps an item to one item with a number of worker threads; a sink
+// consumes items. Queues hold at most `capacity` items, so a slow stage
+// blocks the stages before it. Items are tagged with their order at the
+// source; an ordered stage emits its results in that order, otherwise in the
+// order they are done. Items are typically batches, e.g., blocks of lines, to
+// amortize the queue operations.
+//
+// If a stage function throws, all queues are closed so that the other stages
+// stop, and wait() rethrows the first exception.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "synqueue.h"
+
+namespace syn {
+
+class Pipeline {
+public:
+    /**
+     * Counters of a stage.
+     */
+    struct Stats {
+        std::string name;
+        int workers;
+        std::atomic<long> items{0};
+        std::atomic<long> busy_ns{0};  // time spent in the stage function
+        Stats(const std::string& nm, const int w) : name(nm), workers(w) {}
+    };
+
+    template <class T>
+    class Link;
+
+private:
+    template <class T>
+    using Channel = SynQueue<std::pair<long, T>>;
+
+    /**
+     * Emits results of a stage in source order. Workers wait when their
+     * result is more than `window` items ahead of the next one to emit.
+     */
+    template <class T>
+    struct Reorder {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::map<long, T> pending;
+        long next = 0;
+    };
+
+    size_t capacity_;
+    std::vector<std::thread> threads_;
+    std::vector<std::unique_ptr<Stats>> stats_;
+    std::chrono::steady_clock::time_point start_;
+
+    // the first exception of a stage, and how to stop each stage's output
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+    std::atomic<bool> failed_{false};
+    std::vector<std::function<void()>> closers_;
+
+private:
+    Stats* addStats(const std::string& name, const int workers) {
+        stats_.emplace_back(new Stats(name, workers));
+        return stats_.back().get();
+    }
+
+    /**
+     * Register how to stop the output of a stage on failure.
+     */
+    void addCloser(std::function<void()> closer) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (failed_) closer();
+        closers_.push_back(std::move(closer));
+    }
+
+    /**
+     * Keep the first exception and close all queues.
+     */
+    void fail(std::exception_ptr err) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_) error_ = err;
+        failed_ = true;
+        for (auto& closer : closers_) closer();
+    }
+
+    /**
+     * Run body in a new thread, passing its exception to fail().
+     */
+    template <class F>
+    void spawn(F&& body) {
+        threads_.emplace_back([this, body = std::forward<F>(body)]() mutable {
+            try {
+                body();
+            } catch (...) {
+                fail(std::current_exception());
+            }
+        });
+    }
+
+    void join() {
+        for (auto& t : threads_) t.join();
+        threads_.clear();
+    }
+
+    /**
+     * Run fn and account its time to st.
+     */
+    template <class F>
+    static decltype(auto) timed(Stats* st, F&& fn) {
+        struct Timer {
+            Stats* st;
+            std::chrono::steady_clock::time_point t0 =
+                std::chrono::steady_clock::now();
+            ~Timer() {
+                st->busy_ns += std::chrono::duration_cast<
+                                   std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now() - t0)
+                                   .count();
+                st->items++;
+            }
+        } timer{st};
+        return fn();
+    }
+
+public:
+    Pipeline(const size_t capacity = 16)
+        : capacity_(capacity), start_(std::chrono::steady_clock::now()) {}
+
+    // disable copy constructor
+    Pipeline(const Pipeline&) = delete;
+
+    // disable copy assignment
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    ~Pipeline() { join(); }
+
+    /**
+     * Start the source, which fills an item and returns true, or returns false
+     * at the end of input.
+     */
+    template <class T, class F>
+    Link<T> source(const std::string& name, F&& gen) {
+        auto out = std::make_shared<Channel<T>>(capacity_);
+        Stats* st = addStats(name, 1);
+        addCloser([out] { out->close(); });
+        spawn([this, out, st, gen = std::forward<F>(gen)]() mutable {
+            for (long seq = 0; !failed_; seq++) {
+                T item;
+                if (!timed(st, [&] { return gen(item); })) {
+                    st->items--;
+                    break;
+                }
+                if (!out->push(std::make_pair(seq, std::move(item)))) break;
+            }
+            out->close();
+        });
+        return Link<T>(this, out);
+    }
+
+    /**
+     * Block until all stages are done. Rethrow the first exception of a stage.
+     */
+    void wait() {
+        join();
+        if (error_) {
+            std::exception_ptr err = error_;
+            error_ = nullptr;
+            std::rethrow_exception(err);
+        }
+    }
+
+    const std::vector<std::unique_ptr<Stats>>& getStats() const {
+        return stats_;
+    }
+
+    /**
+     * Print items, throughput and utilization of the workers of each stage.
+     */
+    void printStats(FILE* fp = stdout) const {
+        double secs = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start_)
+                          .count();
+        for (auto& st : stats_) {
+            std::fprintf(fp, "%-12s x%-3d %10ld items %12.1f items/s",
+                         st->name.c_str(), st->workers, st->items.load(),
+                         st->items / secs);
+            std::fprintf(fp, " %5.1f%% busy\n",
+                         100.0 * st->busy_ns / 1e9 / secs / st->workers);
+        }
+    }
+
+    /**
+     * The output of a stage, to which the next stage is attached.
+     */
+    template <class T>
+    class Link {
+    private:
+        Pipeline* pipe_;
+        std::shared_ptr<Channel<T>> in_;
+
+    public:
+        Link(Pipeline* pipe, std::shared_ptr<Channel<T>> in)
+            : pipe_(pipe), in_(std::move(in)) {}
+
+        /**
+         * Add a stage mapping an item to fn(item) with given workers. If
+         * ordered, results are passed on in source order.
+         */
+        template <class F>
+        auto then(const std::string& name, const int workers, F&& fn,
+                  const bool ordered = false) {
+            using Out = std::decay_t<std::invoke_result_t<F&, T&>>;
+            auto out = std::make_shared<Channel<Out>>(pipe_->capacity_);
+            auto reorder = std::make_shared<Reorder<Out>>();
+            auto left = std::make_shared<std::atomic<int>>(workers);
+            const long window = pipe_->capacity_ + workers;
+            Stats* st = pipe_->addStats(name, workers);
+            // wake ordered workers too, as their turn may never come
+            pipe_->addCloser([out, reorder] {
+                out->close();
+                { std::lock_guard<std::mutex> lock(reorder->mutex); }
+                reorder->cond.notify_all();
+            });
+            Pipeline* pipe = pipe_;
+            auto in = in_;
+            for (int w = 0; w < workers; w++)
+                pipe_->spawn([=]() mutable {
+                    std::pair<long, T> item;
+                    while (!pipe->failed_ && in->pop(item)) {
+                        Out res = timed(st, [&] { return fn(item.second); });
+                        if (!ordered) {
+                            out->push(std::make_pair(item.first,
+                                                     std::move(res)));
+                            continue;
+                        }
+                        std::unique_lock<std::mutex> lock(reorder->mutex);
+                        reorder->cond.wait(lock, [&] {
+                            return pipe->failed_ ||
+                                   item.first < reorder->next + window;
+                        });
+                        if (pipe->failed_) break;
+                        reorder->pending.emplace(item.first, std::move(res));
+                        auto it = reorder->pending.begin();
+                        while (it != reorder->pending.end() &&
+                               it->first == reorder->next) {
+                            out->push(std::make_pair(it->first,
+                                                     std::move(it->second)));
+                            it = reorder->pending.erase(it);
+                            reorder->next++;
+                        }
+                        lock.unlock();
+                        reorder->cond.notify_all();
+                    }
+                    // the last worker closes the output
+                    if (left->fetch_sub(1) == 1) out->close();
+                });
+            return Link<Out>(pipe_, out);
+        }
+
+        /**
+         * Consume items with fn in one thread, in the order they arrive.
+         */
+        template <class F>
+        void sink(const std::string& name, F&& fn) {
+            Stats* st = pipe_->addStats(name, 1);
+            Pipeline* pipe = pipe_;
+            auto in = in_;
+            pipe_->spawn([pipe, in, st, fn = std::forward<F>(fn)]() mutable {
+                std::pair<long, T> item;
+                while (!pipe->failed_ && in->pop(item))
+                    timed(st, [&] { return fn(item.second); });
+            });
+        }
+    };
+};
+
+}  // namespace syn
+
+#endif
@@ -3,18 +3,19 @@
  * Distributed under terms of the MIT license.
  */
 
+#include <numeric>
+
 #include "rngutils.h"
+#include "bulk_rng.h"
 
 namespace rngutils {
 
 void initUniform(std::vector<double> &dist, const size_t &start) {
     if (start > 0) std::fill(dist.begin(), dist.begin() + start, 0);
-    double sum = 0;
-    rngutils::default_rng rng;
-    for (size_t i = start; i < dist.size(); i++) {
-        dist[i] = rng.uniform();
-        sum += dist[i];
-    }
+    if (start >= dist.size()) return;
+    rngutils::bulk_rng rng;
+    rng.fill(dist.data() + start, dist.size() - start);
+    double sum = std::accumulate(dist.begin() + start, dist.end(), 0.0);
     for (size_t i = start; i < dist.size(); i++) dist[i] /= sum;
 }
 
@@ -6,6 +6,7 @@
 #ifndef __RNGUTILS_H__
 #define __RNGUTILS_H__
 
+#include <cmath>
 #include <unordered_set>
 
 #include "random_generator.h"
@@ -57,13 +58,158 @@ const Numeric choose(const std::vector<Numeric> &population,
 }
 
 /**
- * Choose num elements from the population uniformly at random without
- * replacemet.
+ * Draw n distinct indices from [0, N) uniformly at random, using Floyd's
+ * algorithm. It takes O(n) expected time and space, independent of N.
+ *
+ * Refer to J. Bentley and B. Floyd. A Sample of Brilliance. CACM, 1987.
  *
- * Refer to https://stackoverflow.com/a/311716/1661545
+ * Return: n indices in no particular order. If N < n, then return all of the
+ * N indices.
+ */
+template <typename RandomEngine = std::default_random_engine,
+          typename DefaultSeedSeq = auto_seed_256>
+std::vector<size_t> sampleFloyd(
+    const size_t N, const size_t n,
+    random_generator<RandomEngine, DefaultSeedSeq> &rng) {
+    size_t num = std::min(n, N);
+    std::vector<size_t> samples;
+    samples.reserve(num);
+    std::unordered_set<size_t> chosen(num * 2);
+    for (size_t j = N - num; j < N; j++) {
+        size_t t = rng.uniform(std::size_t{0}, j);
+        if (!chosen.insert(t).second) {
+            chosen.insert(j);
+            t = j;
+        }
+        samples.push_back(t);
+    }
+    return samples;
+}
+
+/**
+ * Draw n distinct indices from [0, N) uniformly at random, using Vitter's
+ * Algorithm D. Instead of testing every index it generates the skip between
+ * two consecutive selected indices, so it takes O(n) expected time and O(1)
+ * extra space. When n is large relative to N, it falls back to Algorithm A.
+ *
+ * Refer to J. S. Vitter. An Efficient Algorithm for Sequential Random
+ * Sampling. ACM TOMS, 1987.
+ *
+ * Return: n indices in increasing order. If N < n, then return all of the N
+ * indices.
+ */
+template <typename RandomEngine = std::default_random_engine,
+          typename DefaultSeedSeq = auto_seed_256>
+std::vector<size_t> sampleVitter(
+    size_t N, const size_t n,
+    random_generator<RandomEngine, DefaultSeedSeq> &rng) {
+    std::vector<size_t> samples;
+    size_t num = std::min(n, N);
+    if (num == 0) return samples;
+    samples.reserve(num);
+    if (num == N) {
+        for (size_t i = 0; i < N; i++) samples.push_back(i);
+        return samples;
+    }
+
+    // uniform random number in (0,1]
+    auto U = [&rng]() { return 1.0 - rng.uniform(); };
+    const long negalphainv = -13;  // n/N threshold of switching to method A
+
+    long cur = -1;  // the last selected index
+    long rem = num;
+    double nreal = rem, ninv = 1.0 / nreal, Nreal = N;
+    double vprime = std::exp(std::log(U()) * ninv);
+    long qu1 = -rem + 1 + (long)N;
+    double qu1real = -nreal + 1.0 + Nreal;
+    long threshold = -negalphainv * rem;
+
+    while (rem > 1 && threshold < (long)N) {
+        double nmin1inv = 1.0 / (-1.0 + nreal), X, negSreal;
+        long S;
+        while (true) {
+            // step D2: generate U and X
+            while (true) {
+                X = Nreal * (-vprime + 1.0);
+                S = (long)X;
+                if (S < qu1) break;
+                vprime = std::exp(std::log(U()) * ninv);
+            }
+            double u = U();
+            negSreal = -S;
+            // step D3: accept?
+            double y1 = std::exp(std::log(u * Nreal / qu1real) * nmin1inv);
+            vprime = y1 * (-X / Nreal + 1.0) * (qu1real / (negSreal + qu1real));
+            if (vprime <= 1.0) break;
+            // step D4: accept?
+            double y2 = 1.0, top = -1.0 + Nreal, bottom;
+            long limit;
+            if (rem - 1 > S) {
+                bottom = -nreal + Nreal;
+                limit = -S + (long)N;
+            } else {
+                bottom = -1.0 + negSreal + Nreal;
+                limit = qu1;
+            }
+            for (long t = (long)N - 1; t >= limit; t--) {
+                y2 = (y2 * top) / bottom;
+                top--;
+                bottom--;
+            }
+            if (Nreal / (-X + Nreal) >= y1 * std::exp(std::log(y2) * nmin1inv)) {
+                vprime = std::exp(std::log(U()) * nmin1inv);
+                break;
+            }
+            vprime = std::exp(std::log(U()) * ninv);
+        }
+        // step D5: select the (S+1)-st record
+        cur += S + 1;
+        samples.push_back(cur);
+        N = -S + ((long)N - 1);
+        Nreal = negSreal + (-1.0 + Nreal);
+        rem--;
+        nreal--;
+        ninv = nmin1inv;
+        qu1 = -S + qu1;
+        qu1real = negSreal + qu1real;
+        threshold += negalphainv;
+    }
+
+    if (rem > 1) {  // method A for the remaining records
+        double top = (double)N - rem;
+        Nreal = N;
+        while (rem >= 2) {
+            double v = rng.uniform(), quot = top / Nreal;
+            long S = 0;
+            while (quot > v) {
+                S++;
+                top--;
+                Nreal--;
+                quot = (quot * top) / Nreal;
+            }
+            cur += S + 1;
+            samples.push_back(cur);
+            Nreal--;
+            rem--;
+        }
+        long S = (long)(std::round(Nreal) * rng.uniform());
+        cur += S + 1;
+        samples.push_back(cur);
+    } else {
+        long S = (long)(N * vprime);
+        cur += S + 1;
+        samples.push_back(cur);
+    }
+    return samples;
+}
+
+/**
+ * Choose num elements from the population uniformly at random without
+ * replacemet. The selected indices are generated by Vitter's Algorithm D, so
+ * it takes O(num) expected time rather than a scan of the population.
  *
- * Return: a vector of samples, if population.size() < num, then return
- * population.
+ * Return: a vector of samples in population order, if population.size() <
+ * num, then return population.
  * Require: the population is non-empty
  */
 template <typename Numeric, typename RandomEngine = std::default_random_engine,
@@ -71,25 +217,102 @@ template <typename Numeric, typename RandomEngine = std::default_random_engine,
 std::vector<Numeric> choose(
     const std::vector<Numeric> &population, const int num,
     random_generator<RandomEngine, DefaultSeedSeq> &rng) {
-    int N = population.size(), n = std::min(num, N);
+    std::vector<Numeric> samples;
+    samples.reserve(std::min((size_t)num, population.size()));
+    for (size_t idx : sampleVitter(population.size(), num, rng))
+        samples.push_back(population[idx]);
+    return samples;
+}
+
+/**
+ * Same as choose(population, num, rng), but use Floyd's algorithm. Samples
+ * are not in population order.
+ */
+template <typename Numeric, typename RandomEngine = std::default_random_engine,
+          typename DefaultSeedSeq = auto_seed_256>
+std::vector<Numeric> chooseFloyd(
+    const std::vector<Numeric> &population, const int num,
+    random_generator<RandomEngine, DefaultSeedSeq> &rng) {
+    std::vector<Numeric> samples;
+    samples.reserve(std::min((size_t)num, population.size()));
+    for (size_t idx : sampleFloyd(population.size(), num, rng))
+        samples.push_back(population[idx]);
+    return samples;
+}
+
+/**
+ * Reservoir sampling over a stream of unknown length, using Li's Algorithm L.
+ * After the reservoir is full, the number of items to skip before the next
+ * replacement is drawn directly, so only O(k log(N/k)) random numbers are
+ * needed for a stream of N items.
+ *
+ * Refer to K. Li. Reservoir-Sampling Algorithms of Time Complexity
+ * O(n(1+log(N/n))). ACM TOMS, 1994.
+ *
+ * Usage:
+ *
+ *   Reservoir<int> rsv(k, rng);
+ *   while (ss.next()) {
+ *       if (rsv.wanted()) rsv.add(ss.get<int>(0));
+ *       else rsv.skip();
+ *   }
+ */
+template <typename T, typename RandomEngine = std::default_random_engine,
+          typename DefaultSeedSeq = auto_seed_256>
+class Reservoir {
+private:
+    size_t capacity_, seen_, next_;
+    double w_;
+    std::vector<T> samples_;
+    random_generator<RandomEngine, DefaultSeedSeq> &rng_;
+
+private:
+    // uniform random number in (0,1]
+    double U() { return 1.0 - rng_.uniform(); }
 
-    int t = 0;  // total input records dealt with
-    int m = 0;  // number of items selected so far
+    // position of the next item to be selected
+    void advance() {
+        w_ *= std::exp(std::log(U()) / capacity_);
+        next_ += (size_t)(std::log(U()) / std::log1p(-w_)) + 1;
+    }
 
-    std::vector<Numeric> samples(n);
+public:
+    Reservoir(const size_t capacity,
+              random_generator<RandomEngine, DefaultSeedSeq> &rng)
+        : capacity_(capacity), seen_(0), next_(SIZE_MAX), w_(1.0), rng_(rng) {
+        samples_.reserve(capacity_);
+    }
 
-    while (m < n) {
-        double u = rng.uniform();
-        if ((N - t) * u >= n - m) {
-            t++;
-        } else {
-            samples[m] = population[t];
-            t++;
-            m++;
+    /**
+     * Return true if the next item of the stream enters the reservoir. Items
+     * that are not wanted can be passed to skip() without being constructed.
+     */
+    bool wanted() const { return seen_ < capacity_ || seen_ == next_; }
+
+    void skip() { seen_++; }
+
+    void add(const T &item) {
+        if (seen_ < capacity_) {
+            samples_.push_back(item);
+            if (++seen_ == capacity_) {
+                next_ = capacity_ - 1;
+                advance();
+            }
+            return;
         }
+        if (seen_ == next_) {
+            samples_[rng_.uniform(std::size_t{0}, capacity_ - 1)] = item;
+            advance();
+        }
+        seen_++;
     }
-    return samples;
-}
+
+    // Number of items that have passed through the stream.
+    size_t getSeen() const { return seen_; }
+
+    const std::vector<T> &getSamples() const { return samples_; }
+    std::vector<T> &getSamples() { return samples_; }
+};
 
 /**
  * Initialize a vector 'dist' with uniformly distributed random numbers, s.t.
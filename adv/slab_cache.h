@@ -0,0 +1,261 @@
+#ifndef __SLAB_CACHE_H__
+#define __SLAB_CACHE_H__
+// An LRU cache with the API of lru::Cache and a few words of overhead per
+// entry. Entries are stored in one vector (the slab), which is allocated up to
+// the capacity once, and linked into the LRU list by 32-bit indices instead of
+// pointers. Keys are located by an open-addressing (linear probing) index
+// holding the slab position of each key, at most 2/3 full. Evicted and removed
+// entries are reused, so inserts do not allocate.
+//
+// Compared with lru::Cache, which allocates a list node and a map node per
+// entry (about 80 bytes of overhead on 64-bit systems), an entry costs 8 bytes
+// of links and 6 to 12 bytes of index.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "LRUCache.h"
+
+namespace lru {
+
+template <class Key, class Value, class Lock = NullLock,
+          class Hash = std::hash<Key>>
+class SlabCache {
+public:
+    /**
+     * An entry of the slab; cwalk() passes entries to the walker, which can
+     * access key and value as with lru::Cache.
+     */
+    struct Entry {
+        Key key;
+        Value value;
+        uint32_t prev, next;  // LRU list, or next free entry
+
+        Entry(const Key& k, const Value& v) : key(k), value(v) {}
+    };
+
+    typedef Lock lock_type;
+    using Guard = std::lock_guard<lock_type>;
+
+private:
+    static constexpr uint32_t NIL = std::numeric_limits<uint32_t>::max();
+
+    std::vector<Entry> slab_;
+    std::vector<uint32_t> index_;  // slab positions, or NIL
+    size_t mask_;
+    size_t maxSize_, size_ = 0;
+    uint32_t head_ = NIL, tail_ = NIL;  // most / least recently used
+    uint32_t free_ = NIL;
+    Hash hash_;
+    mutable Lock lock_;
+
+private:
+    size_t getHome(const Key& k) const {
+        return (((uint64_t)hash_(k) * 0x9E3779B97F4A7C15ULL) >> 32) & mask_;
+    }
+
+    /**
+     * Return the index slot holding the key, or the empty slot ending its
+     * probe sequence.
+     */
+    size_t findSlot(const Key& k) const {
+        size_t i = getHome(k);
+        while (index_[i] != NIL && !(slab_[index_[i]].key == k))
+            i = (i + 1) & mask_;
+        return i;
+    }
+
+    /**
+     * Empty index slot i, moving back later slots of the probe sequence.
+     */
+    void eraseSlot(size_t i) {
+        for (size_t j = (i + 1) & mask_; index_[j] != NIL;
+             j = (j + 1) & mask_) {
+            size_t home = getHome(slab_[index_[j]].key);
+            // skip the slot if its home is in (i, j]
+            if (((j - home) & mask_) < ((j - i) & mask_)) continue;
+            index_[i] = index_[j];
+            i = j;
+        }
+        index_[i] = NIL;
+    }
+
+    void unlink(const uint32_t e) {
+        Entry& ent = slab_[e];
+        if (ent.prev != NIL)
+            slab_[ent.prev].next = ent.next;
+        else
+            head_ = ent.next;
+        if (ent.next != NIL)
+            slab_[ent.next].prev = ent.prev;
+        else
+            tail_ = ent.prev;
+    }
+
+    void pushFront(const uint32_t e) {
+        slab_[e].prev = NIL;
+        slab_[e].next = head_;
+        if (head_ != NIL) slab_[head_].prev = e;
+        head_ = e;
+        if (tail_ == NIL) tail_ = e;
+    }
+
+    void moveToFront(const uint32_t e) {
+        if (e == head_) return;
+        unlink(e);
+        pushFront(e);
+    }
+
+    /**
+     * Remove the entry at index slot i and put it on the free list, releasing
+     * its key and value.
+     */
+    void erase(const size_t i) {
+        uint32_t e = index_[i];
+        eraseSlot(i);
+        unlink(e);
+        slab_[e].key = Key();
+        slab_[e].value = Value();
+        slab_[e].next = free_;
+        free_ = e;
+        size_--;
+    }
+
+public:
+    /**
+     * The cache holds at most maxSize (> 0, < 2^32 - 1) keys, evicting the
+     * least recently used key when full.
+     */
+    explicit SlabCache(size_t maxSize = 64)
+        : maxSize_(std::max<size_t>(1, maxSize)) {
+        if (maxSize_ >= NIL) {
+            fprintf(stderr, "SlabCache: maxSize %zu is too large.\n", maxSize_);
+            exit(1);
+        }
+        size_t slots = 4;
+        while (slots < maxSize_ + maxSize_ / 2) slots <<= 1;
+        index_.assign(slots, NIL);
+        mask_ = slots - 1;
+        slab_.reserve(maxSize_);
+    }
+
+    virtual ~SlabCache() = default;
+
+    size_t size() const {
+        Guard g(lock_);
+        return size_;
+    }
+
+    bool empty() const {
+        Guard g(lock_);
+        return size_ == 0;
+    }
+
+    void clear() {
+        Guard g(lock_);
+        slab_.clear();
+        std::fill(index_.begin(), index_.end(), NIL);
+        size_ = 0;
+        head_ = tail_ = free_ = NIL;
+    }
+
+    void insert(const Key& k, const Value& v) {
+        Guard g(lock_);
+        size_t i = findSlot(k);
+        if (index_[i] != NIL) {
+            slab_[index_[i]].value = v;
+            moveToFront(index_[i]);
+            return;
+        }
+        if (size_ >= maxSize_) {
+            erase(findSlot(slab_[tail_].key));
+            i = findSlot(k);
+        }
+        uint32_t e;
+        if (free_ != NIL) {
+            e = free_;
+            free_ = slab_[e].next;
+            slab_[e].key = k;
+            slab_[e].value = v;
+        } else {
+            e = slab_.size();
+            slab_.emplace_back(k, v);
+        }
+        index_[i] = e;
+        pushFront(e);
+        size_++;
+    }
+
+    bool tryGet(const Key& kIn, Value& vOut) {
+        Guard g(lock_);
+        size_t i = findSlot(kIn);
+        if (index_[i] == NIL) return false;
+        moveToFront(index_[i]);
+        vOut = slab_[index_[i]].value;
+        return true;
+    }
+
+    /**
+     *	The const reference returned here is only
+     *    guaranteed to be valid till the next insert/delete
+     */
+    const Value& get(const Key& k) {
+        Guard g(lock_);
+        size_t i = findSlot(k);
+        if (index_[i] == NIL) throw KeyNotFound();
+        moveToFront(index_[i]);
+        return slab_[index_[i]].value;
+    }
+
+    /**
+     * returns a copy of the stored object (if found)
+     */
+    Value getCopy(const Key& k) { return get(k); }
+
+    bool remove(const Key& k) {
+        Guard g(lock_);
+        size_t i = findSlot(k);
+        if (index_[i] == NIL) return false;
+        erase(i);
+        return true;
+    }
+
+    bool contains(const Key& k) {
+        Guard g(lock_);
+        return index_[findSlot(k)] != NIL;
+    }
+
+    size_t getMaxSize() const { return maxSize_; }
+
+    /**
+     * Bytes allocated for the slab and the index.
+     */
+    size_t getBytes() const {
+        return slab_.capacity() * sizeof(Entry) +
+               index_.size() * sizeof(uint32_t);
+    }
+
+    /**
+     * Walk entries from the most to the least recently used.
+     */
+    template <typename F>
+    void cwalk(F& f) const {
+        Guard g(lock_);
+        for (uint32_t e = head_; e != NIL; e = slab_[e].next) f(slab_[e]);
+    }
+
+private:
+    // Dissallow copying.
+    SlabCache(const SlabCache&) = delete;
+    SlabCache& operator=(const SlabCache&) = delete;
+};
+
+}  // namespace lru
+
+#endif /* __SLAB_CACHE_H__ */
@@ -1,19 +1,120 @@
 #ifndef __CONCURRENT_QUEUE__
 #define __CONCURRENT_QUEUE__
 
+#include <algorithm>
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
-#include <queue>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace syn {
 
 template <typename T>
 class SynQueue {
 private:
-    std::queue<T> queue_;
-    std::mutex mutex_;
+    // queued items are queue_[head_..]; a vector, so that batches can be
+    // handed over by swapping buffers
+    std::vector<T> queue_;
+    size_t head_ = 0;
+    mutable std::mutex mutex_;
     std::condition_variable item_avail_cond_, space_avail_cond_;
     size_t capacity_;
+    bool closed_ = false;
+    // number of threads waiting for items / space, to skip needless notifies
+    int item_waiters_ = 0, space_waiters_ = 0;
+
+private:
+    size_t count() const { return queue_.size() - head_; }
+
+    /**
+     * Drop the first n queued items, which have been moved out.
+     */
+    void advance(const size_t n) {
+        head_ += n;
+        if (head_ == queue_.size()) {
+            queue_.clear();
+            head_ = 0;
+        } else if (head_ >= 64 && 2 * head_ >= queue_.size()) {
+            // reclaim the moved-from prefix; amortized O(1) per item
+            queue_.erase(queue_.begin(), queue_.begin() + head_);
+            head_ = 0;
+        }
+    }
+
+    /**
+     * Wait until an item is available or the queue is closed, up to the
+     * deadline if given. Return false if no item is available.
+     */
+    bool waitItem(std::unique_lock<std::mutex>& mlock,
+                  const std::chrono::steady_clock::time_point* deadline) {
+        item_waiters_++;
+        while (count() == 0 && !closed_) {
+            if (deadline == nullptr) {
+                item_avail_cond_.wait(mlock);
+            } else if (item_avail_cond_.wait_until(mlock, *deadline) ==
+                       std::cv_status::timeout) {
+                break;
+            }
+        }
+        item_waiters_--;
+        return count() > 0;
+    }
+
+    /**
+     * Wait until there is space or the queue is closed, up to the deadline if
+     * given. Return false if there is no space or the queue is closed.
+     */
+    bool waitSpace(std::unique_lock<std::mutex>& mlock,
+                   const std::chrono::steady_clock::time_point* deadline) {
+        space_waiters_++;
+        while (count() >= capacity_ && !closed_) {
+            if (deadline == nullptr) {
+                space_avail_cond_.wait(mlock);
+            } else if (space_avail_cond_.wait_until(mlock, *deadline) ==
+                       std::cv_status::timeout) {
+                break;
+            }
+        }
+        space_waiters_--;
+        return !closed_ && count() < capacity_;
+    }
+
+    /**
+     * Pop the front item and notify a producer. The lock is released.
+     */
+    void popLocked(T& item, std::unique_lock<std::mutex>& mlock) {
+        item = std::move(queue_[head_]);
+        advance(1);
+        notifySpace(mlock);
+    }
+
+    /**
+     * Notify a producer, releasing the lock.
+     */
+    void notifySpace(std::unique_lock<std::mutex>& mlock) {
+        bool notify = space_waiters_ > 0;
+        mlock.unlock();
+        if (notify) space_avail_cond_.notify_one();
+    }
+
+    /**
+     * Push an item and notify a consumer. The lock is released.
+     */
+    template <class U>
+    void pushLocked(U&& item, std::unique_lock<std::mutex>& mlock) {
+        queue_.push_back(std::forward<U>(item));
+        bool notify = item_waiters_ > 0;
+        // unlock before notificiation to minimize mutex contention
+        mlock.unlock();
+        // notify one waiting thread
+        if (notify) item_avail_cond_.notify_one();
+    }
 
 public:
     SynQueue() : capacity_(std::numeric_limits<size_t>::max()) {}
@@ -31,27 +132,49 @@ public:
      * case, the call to wait() returns and we check the while condition again.
      * This extra check is because conditions may experience spurious wakes: we
      * could be wrongly notified while the queue is still empty.
+     *
+     * If the queue is closed and drained, a default item is returned (and the
+     * program exits if T has no default constructor); use pop(item) to tell
+     * this case apart.
      */
     T pop() {
         std::unique_lock<std::mutex> mlock(mutex_);
-        while (queue_.empty()) item_avail_cond_.wait(mlock);
-        auto val = queue_.front();
-        queue_.pop();
-        mlock.unlock();
-        space_avail_cond_.notify_one();
+        if (!waitItem(mlock, nullptr)) {
+            if constexpr (std::is_default_constructible<T>::value) {
+                return T();
+            } else {
+                fprintf(stderr, "pop() on a closed and drained queue.\n");
+                exit(1);
+            }
+        }
+        T val = std::move(queue_[head_]);
+        advance(1);
+        notifySpace(mlock);
         return val;
     }
 
     /**
-     * An different version of previous pop().
+     * An different version of previous pop(). Return false if the queue is
+     * closed and drained.
      */
-    void pop(T& item) {
+    bool pop(T& item) {
         std::unique_lock<std::mutex> mlock(mutex_);
-        while (queue_.empty()) item_avail_cond_.wait(mlock);
-        item = queue_.front();
-        queue_.pop();
-        mlock.unlock();
-        space_avail_cond_.notify_one();
+        if (!waitItem(mlock, nullptr)) return false;
+        popLocked(item, mlock);
+        return true;
+    }
+
+    /**
+     * Pop with a timeout. Return false if no item arrived in time, or if the
+     * queue is closed and drained.
+     */
+    template <class Rep, class Period>
+    bool pop(T& item, const std::chrono::duration<Rep, Period>& timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock<std::mutex> mlock(mutex_);
+        if (!waitItem(mlock, &deadline)) return false;
+        popLocked(item, mlock);
+        return true;
     }
 
     /**
@@ -60,37 +183,130 @@ public:
      */
     bool tryPop(T& item) {
         std::unique_lock<std::mutex> mlock(mutex_);
-        if (queue_.empty()) return false;
-        item = queue_.front();
-        queue_.pop();
+        if (count() == 0) return false;
+        popLocked(item, mlock);
+        return true;
+    }
+
+    /**
+     * Move up to max_items items to the end of 'items' under one lock,
+     * blocking until at least one is available. If 'items' is empty and all
+     * queued items are taken, the buffers are swapped instead. Return false if
+     * the queue is closed and drained.
+     */
+    bool popBatch(std::vector<T>& items,
+                  const size_t max_items = std::numeric_limits<size_t>::max()) {
+        std::unique_lock<std::mutex> mlock(mutex_);
+        if (!waitItem(mlock, nullptr)) return false;
+        size_t n = std::min(max_items, count());
+        if (n == queue_.size() && items.empty()) {
+            queue_.swap(items);
+        } else {
+            auto first = queue_.begin() + head_;
+            items.insert(items.end(), std::make_move_iterator(first),
+                         std::make_move_iterator(first + n));
+            advance(n);
+        }
+        bool notify = space_waiters_ > 0;
         mlock.unlock();
-        space_avail_cond_.notify_one();
+        if (notify) space_avail_cond_.notify_all();
         return true;
     }
 
     /**
      * Push an item into the queue. If there is no available space, the thread
      * blocks and wait for condition 'space_avail_cond_'. The thread resumes
-     * once the condition is met.
+     * once the condition is met. Return false if the queue is closed.
      */
-    void push(const T& item) {
+    bool push(const T& item) {
         std::unique_lock<std::mutex> mlock(mutex_);
-        while (queue_.size() >= capacity_) space_avail_cond_.wait(mlock);
-        queue_.push(item);
-        // unlock before notificiation to minimize mutex contention
-        mlock.unlock();
-        // notify one waiting thread
-        item_avail_cond_.notify_one();
+        if (!waitSpace(mlock, nullptr)) return false;
+        pushLocked(item, mlock);
+        return true;
+    }
+
+    /**
+     * As push(item), moving the item into the queue.
+     */
+    bool push(T&& item) {
+        std::unique_lock<std::mutex> mlock(mutex_);
+        if (!waitSpace(mlock, nullptr)) return false;
+        pushLocked(std::move(item), mlock);
+        return true;
+    }
+
+    /**
+     * Push with a timeout. Return false if no space became available in time,
+     * or if the queue is closed.
+     */
+    template <class Rep, class Period>
+    bool push(const T& item,
+              const std::chrono::duration<Rep, Period>& timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock<std::mutex> mlock(mutex_);
+        if (!waitSpace(mlock, &deadline)) return false;
+        pushLocked(item, mlock);
+        return true;
     }
 
     bool tryPush(const T& item) {
         std::unique_lock<std::mutex> mlock(mutex_);
-        if (queue_.size() >= capacity_) return false;
-        queue_.push(item);
-        // unlock before notificiation to minimize mutex contention
+        if (closed_ || count() >= capacity_) return false;
+        pushLocked(item, mlock);
+        return true;
+    }
+
+    /**
+     * Move all items of 'items' into the queue, and clear it. Items are moved
+     * in as many as fit at a time, blocking until there is space, so the
+     * capacity holds. If the queue is empty and the whole batch fits, the
+     * buffers are swapped instead. Return false if the queue is closed; the
+     * items not pushed are then left in 'items'.
+     */
+    bool pushBatch(std::vector<T>& items) {
+        std::unique_lock<std::mutex> mlock(mutex_);
+        size_t i = 0;
+        while (i < items.size()) {
+            if (!waitSpace(mlock, nullptr)) {
+                items.erase(items.begin(), items.begin() + i);
+                return false;
+            }
+            size_t n = std::min(items.size() - i, capacity_ - count());
+            if (n == items.size() && queue_.empty()) {
+                queue_.swap(items);
+            } else {
+                auto first = items.begin() + i;
+                queue_.insert(queue_.end(), std::make_move_iterator(first),
+                              std::make_move_iterator(first + n));
+            }
+            i += n;
+            // wake consumers to make room for the rest
+            if (i < items.size() && item_waiters_ > 0)
+                item_avail_cond_.notify_all();
+        }
+        bool closed = closed_, notify = item_waiters_ > 0;
         mlock.unlock();
-        // notify one waiting thread
-        item_avail_cond_.notify_one();
+        items.clear();
+        if (notify) item_avail_cond_.notify_all();
+        return !closed;
+    }
+
+    /**
+     * Close the queue: pushes fail from now on, and consumers get false once
+     * the remaining items are drained. Blocked threads are woken up.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> mlock(mutex_);
+            closed_ = true;
+        }
+        item_avail_cond_.notify_all();
+        space_avail_cond_.notify_all();
+    }
+
+    bool isClosed() const {
+        std::lock_guard<std::mutex> mlock(mutex_);
+        return closed_;
     }
 
     /**
@@ -98,10 +314,13 @@ public:
      */
     bool empty() {
         std::unique_lock<std::mutex> mlock(mutex_);
-        return queue_.empty();
+        return count() == 0;
     }
 
-    const size_t getSize() const { return queue_.size(); }
+    const size_t getSize() const {
+        std::lock_guard<std::mutex> mlock(mutex_);
+        return count();
+    }
 };
 }  // namespace syn
 #endif
@@ -1,9 +1,14 @@
 #ifndef __THREAD_POOL_H__
 #define __THREAD_POOL_H__
 
+#include <condition_variable>
 #include <functional>
 #include <future>
+#include <mutex>
 #include <queue>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 namespace syn {
 
@@ -12,6 +17,12 @@ public:
     explicit ThreadPool(size_t);
     template <class F, class... Args>
     decltype(auto) enqueue(F&& f, Args&&... args);
+
+    // add a void() job without a future, for callers doing their own join
+    template <class F>
+    void post(F&& f);
+
+    size_t size() const { return workers.size(); }
     ~ThreadPool();
 
 private:
@@ -69,8 +80,18 @@ decltype(auto) ThreadPool::enqueue(F&& f, Args&&... args) {
     return res;
 }
 
+template <class F>
+void ThreadPool::post(F&& f) {
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        if (stop) throw std::runtime_error("post on stopped ThreadPool");
+        tasks.emplace(std::forward<F>(f));
+    }
+    condition.notify_one();
+}
+
 // the destructor joins all threads
-ThreadPool::~ThreadPool() {
+inline ThreadPool::~ThreadPool() {
     {
         std::unique_lock<std::mutex> lock(queue_mutex);
         stop = true;
@@ -0,0 +1,364 @@
+#ifndef __TINYLFU_CACHE_H__
+#define __TINYLFU_CACHE_H__
+// A cache bounded by the total weight (e.g., bytes) of its entries, with the
+// W-TinyLFU policy of Einziger et al., "TinyLFU: A Highly Efficient Cache
+// Admission Policy":
+//
+// - New entries enter a small window LRU (1% of the budget by default).
+// - Entries evicted from the window are candidates for the main cache, a
+//   segmented LRU of a probation and a protected segment (80% of the main
+//   cache). Entries hit in probation are promoted to protected, and entries
+//   evicted from protected are demoted to probation.
+// - If the main cache is full, a candidate is admitted only if it is used
+//   more often than the entries it would evict from probation, where use
+//   frequencies are estimated by a count-min sketch of recent accesses.
+//
+// So a scan of keys used once passes through the window without flushing the
+// frequently used keys in the main cache.
+//
+// The weight of an entry is given by a weigher, weigher(key, value); by
+// default each entry weighs 1. Entries heavier than the budget are not kept.
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "LRUCache.h"
+
+namespace lru {
+
+/**
+ * Count-min sketch of 4-bit counters in 4 rows, 16 counters per word. After
+ * 10 * width increments all counters are halved, so that the estimates follow
+ * recent accesses.
+ */
+class FrequencySketch {
+private:
+    std::vector<uint64_t> table_;  // rows of width / 16 words each
+    size_t width_ = 0, row_words_ = 0;
+    size_t additions_ = 0, sample_size_ = 0;
+
+    static constexpr uint64_t SEEDS[4] = {
+        0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL,
+        0xD6E8FEB86659FD93ULL};
+
+    size_t getCounter(const uint64_t h, const int row) const {
+        return ((h * SEEDS[row]) >> 32) & (width_ - 1);
+    }
+
+    void reset() {
+        for (auto& word : table_) word = (word >> 1) & 0x7777777777777777ULL;
+        additions_ /= 2;
+    }
+
+public:
+    FrequencySketch(const size_t width = 1024) { setWidth(width); }
+
+    /**
+     * Set the number of counters per row, rounded up to a power of two of at
+     * least 16. Counters are cleared.
+     */
+    void setWidth(const size_t width) {
+        width_ = 16;
+        while (width_ < width) width_ <<= 1;
+        row_words_ = width_ / 16;
+        table_.assign(4 * row_words_, 0);
+        additions_ = 0;
+        sample_size_ = 10 * width_;
+    }
+
+    size_t getWidth() const { return width_; }
+
+    /**
+     * Double the width, keeping the estimates: counter c of a row maps to
+     * counters c and c + width of the wider row, as the counter index is the
+     * low bits of the mixed hash.
+     */
+    void grow() {
+        std::vector<uint64_t> table(8 * row_words_);
+        for (int r = 0; r < 4; r++) {
+            auto row = table_.begin() + r * row_words_;
+            auto dst = table.begin() + 2 * r * row_words_;
+            std::copy(row, row + row_words_, dst);
+            std::copy(row, row + row_words_, dst + row_words_);
+        }
+        table_.swap(table);
+        width_ *= 2;
+        row_words_ *= 2;
+        sample_size_ = 10 * width_;
+    }
+
+    void increment(const uint64_t h) {
+        bool added = false;
+        for (int r = 0; r < 4; r++) {
+            size_t c = getCounter(h, r);
+            uint64_t& word = table_[r * row_words_ + c / 16];
+            int shift = (c % 16) * 4;
+            if (((word >> shift) & 15) < 15) {
+                word += uint64_t(1) << shift;
+                added = true;
+            }
+        }
+        if (added && ++additions_ >= sample_size_) reset();
+    }
+
+    int frequency(const uint64_t h) const {
+        int freq = 15;
+        for (int r = 0; r < 4; r++) {
+            size_t c = getCounter(h, r);
+            int cnt = (table_[r * row_words_ + c / 16] >> ((c % 16) * 4)) & 15;
+            freq = std::min(freq, cnt);
+        }
+        return freq;
+    }
+
+    void clear() {
+        std::fill(table_.begin(), table_.end(), 0);
+        additions_ = 0;
+    }
+};
+
+template <class Key, class Value, class Lock = NullLock,
+          class Hash = std::hash<Key>>
+class TinyLFUCache {
+public:
+    typedef std::function<size_t(const Key&, const Value&)> weigher_type;
+    typedef Lock lock_type;
+    using Guard = std::lock_guard<lock_type>;
+
+private:
+    enum Segment { WINDOW = 0, PROBATION = 1, PROTECTED = 2 };
+
+    struct Node {
+        Key key;
+        Value value;
+        size_t weight;
+        Segment seg;
+
+        Node(const Key& k, const Value& v, const size_t w)
+            : key(k), value(v), weight(w), seg(WINDOW) {}
+    };
+
+    typedef std::list<Node> list_type;
+    typedef typename list_type::iterator iter_type;
+
+    list_type lists_[3];      // most recently used first
+    size_t weights_[3] = {};  // total weight of each segment
+    std::unordered_map<Key, iter_type, Hash> cache_;
+    FrequencySketch sketch_;
+    weigher_type weigher_;
+    Hash hash_;
+    size_t maxWeight_, maxWindow_, maxProtected_;
+    mutable Lock lock_;
+
+private:
+    uint64_t getHash(const Key& k) const { return hash_(k); }
+
+    /**
+     * Move node to the front of segment seg.
+     */
+    void moveTo(const iter_type it, const Segment seg) {
+        weights_[it->seg] -= it->weight;
+        weights_[seg] += it->weight;
+        lists_[seg].splice(lists_[seg].begin(), lists_[it->seg], it);
+        it->seg = seg;
+    }
+
+    void erase(const iter_type it) {
+        weights_[it->seg] -= it->weight;
+        cache_.erase(it->key);
+        lists_[it->seg].erase(it);
+    }
+
+    /**
+     * Record an access of a cached node.
+     */
+    void touch(const iter_type it) {
+        if (it->seg == PROBATION) {
+            moveTo(it, PROTECTED);
+            // demote the least recently used protected entries
+            while (weights_[PROTECTED] > maxProtected_)
+                moveTo(std::prev(lists_[PROTECTED].end()), PROBATION);
+        } else {
+            moveTo(it, it->seg);
+        }
+    }
+
+    /**
+     * Evict the least recently used entries of the main cache, probation
+     * first, until it has room for weight w.
+     */
+    void makeRoom(const size_t w) {
+        while (weights_[PROBATION] + weights_[PROTECTED] + w >
+               maxWeight_ - maxWindow_) {
+            list_type& victims = lists_[PROBATION].empty()
+                                     ? lists_[PROTECTED]
+                                     : lists_[PROBATION];
+            erase(std::prev(victims.end()));
+        }
+    }
+
+    /**
+     * Whether the candidate is more frequent than each of the victims that
+     * makeRoom() would evict for it.
+     */
+    bool admit(const iter_type cand) const {
+        const size_t maxMain = maxWeight_ - maxWindow_;
+        size_t used = weights_[PROBATION] + weights_[PROTECTED];
+        if (used + cand->weight <= maxMain) return true;
+        size_t need = used + cand->weight - maxMain, freed = 0;
+        int freq = sketch_.frequency(getHash(cand->key));
+        for (int s = PROBATION; s <= PROTECTED && freed < need; s++)
+            for (auto it = lists_[s].rbegin();
+                 it != lists_[s].rend() && freed < need; ++it) {
+                if (freq <= sketch_.frequency(getHash(it->key))) return false;
+                freed += it->weight;
+            }
+        return true;
+    }
+
+    /**
+     * Move candidates from the window to the main cache, each admitted only
+     * if it is more frequent than all the victims it would evict.
+     */
+    void evict() {
+        while (weights_[WINDOW] > maxWindow_) {
+            iter_type cand = std::prev(lists_[WINDOW].end());
+            if (cand->weight > maxWeight_ - maxWindow_ || !admit(cand)) {
+                erase(cand);
+                continue;
+            }
+            makeRoom(cand->weight);
+            moveTo(cand, PROBATION);
+        }
+    }
+
+public:
+    /**
+     * The cache keeps entries of total weight at most maxWeight, of which
+     * windowRatio is for the window.
+     */
+    explicit TinyLFUCache(size_t maxWeight = 64,
+                          weigher_type weigher = weigher_type(),
+                          double windowRatio = 0.01)
+        : weigher_(weigher), maxWeight_(std::max<size_t>(1, maxWeight)) {
+        if (!weigher_) weigher_ = [](const Key&, const Value&) { return 1; };
+        maxWindow_ = std::max<size_t>(1, maxWeight_ * windowRatio);
+        maxWindow_ = std::min(maxWindow_, maxWeight_);
+        maxProtected_ = (maxWeight_ - maxWindow_) * 0.8;
+    }
+
+    virtual ~TinyLFUCache() = default;
+
+    size_t size() const {
+        Guard g(lock_);
+        return cache_.size();
+    }
+
+    bool empty() const {
+        Guard g(lock_);
+        return cache_.empty();
+    }
+
+    /**
+     * Total weight of the entries.
+     */
+    size_t getWeight() const {
+        Guard g(lock_);
+        return weights_[WINDOW] + weights_[PROBATION] + weights_[PROTECTED];
+    }
+
+    void clear() {
+        Guard g(lock_);
+        cache_.clear();
+        for (int s = 0; s < 3; s++) {
+            lists_[s].clear();
+            weights_[s] = 0;
+        }
+        sketch_.clear();
+    }
+
+    void insert(const Key& k, const Value& v) {
+        Guard g(lock_);
+        sketch_.increment(getHash(k));
+        size_t w = weigher_(k, v);
+        const auto iter = cache_.find(k);
+        if (iter != cache_.end()) {
+            iter_type it = iter->second;
+            if (w > maxWeight_) {
+                erase(it);
+                return;
+            }
+            weights_[it->seg] += w - it->weight;
+            it->value = v;
+            it->weight = w;
+            touch(it);
+        } else {
+            if (w > maxWeight_) return;
+            lists_[WINDOW].emplace_front(k, v, w);
+            weights_[WINDOW] += w;
+            cache_[k] = lists_[WINDOW].begin();
+            // keep the sketch about as wide as the number of entries
+            if (cache_.size() > sketch_.getWidth()) sketch_.grow();
+        }
+        // a grown entry may overflow the main cache too
+        makeRoom(0);
+        evict();
+    }
+
+    bool tryGet(const Key& kIn, Value& vOut) {
+        Guard g(lock_);
+        sketch_.increment(getHash(kIn));
+        const auto iter = cache_.find(kIn);
+        if (iter == cache_.end()) return false;
+        touch(iter->second);
+        vOut = iter->second->value;
+        return true;
+    }
+
+    /**
+     *	The const reference returned here is only
+     *    guaranteed to be valid till the next insert/delete
+     */
+    const Value& get(const Key& k) {
+        Guard g(lock_);
+        sketch_.increment(getHash(k));
+        const auto iter = cache_.find(k);
+        if (iter == cache_.end()) throw KeyNotFound();
+        touch(iter->second);
+        return iter->second->value;
+    }
+
+    /**
+     * returns a copy of the stored object (if found)
+     */
+    Value getCopy(const Key& k) { return get(k); }
+
+    bool remove(const Key& k) {
+        Guard g(lock_);
+        const auto iter = cache_.find(k);
+        if (iter == cache_.end()) return false;
+        erase(iter->second);
+        return true;
+    }
+
+    bool contains(const Key& k) {
+        Guard g(lock_);
+        return cache_.find(k) != cache_.end();
+    }
+
+    size_t getMaxWeight() const { return maxWeight_; }
+
+private:
+    // Dissallow copying.
+    TinyLFUCache(const TinyLFUCache&) = delete;
+    TinyLFUCache& operator=(const TinyLFUCache&) = delete;
+};
+
+}  // namespace lru
+
+#endif /* __TINYLFU_CACHE_H__ */
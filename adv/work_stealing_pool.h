@@ -0,0 +1,378 @@
+#ifndef __WORK_STEALING_POOL_H__
+#define __WORK_STEALING_POOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace syn {
+
+/**
+ * A task whose result is delivered through a future.
+ */
+class PoolTask {
+public:
+    virtual ~PoolTask() {}
+    virtual void run() = 0;
+};
+
+template <class R>
+class PackagedPoolTask : public PoolTask {
+private:
+    std::packaged_task<R()> task_;
+
+public:
+    PackagedPoolTask(std::packaged_task<R()>&& task) : task_(std::move(task)) {}
+    void run() override { task_(); }
+};
+
+template <class F>
+class FnPoolTask : public PoolTask {
+private:
+    F fn_;
+
+public:
+    template <class G>
+    FnPoolTask(G&& fn) : fn_(std::forward<G>(fn)) {}
+    void run() override { fn_(); }
+};
+
+/**
+ * Chase-Lev work-stealing deque of task pointers, following
+ *
+ * N. M. Le, A. Pop, A. Cohen, F. Zappa Nardelli. Correct and Efficient
+ * Work-Stealing for Weak Memory Models. PPoPP, 2013.
+ *
+ * Only the owner pushes and pops at the bottom; other threads steal from the
+ * top. The buffer grows when full; old buffers are kept until the deque is
+ * destroyed since thieves may still read them.
+ */
+class WSDeque {
+private:
+    struct Array {
+        const int64_t cap, mask;
+        std::unique_ptr<std::atomic<PoolTask*>[]> buf;
+
+        Array(const int64_t c)
+            : cap(c), mask(c - 1), buf(new std::atomic<PoolTask*>[c]) {}
+        PoolTask* get(const int64_t i) const {
+            return buf[i & mask].load(std::memory_order_relaxed);
+        }
+        void put(const int64_t i, PoolTask* x) {
+            buf[i & mask].store(x, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<Array*> array_;
+    std::vector<std::unique_ptr<Array>> arrays_;  // current and retired
+
+public:
+    WSDeque(const int64_t cap = 256) {
+        arrays_.emplace_back(new Array(cap));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    // disable copy constructor
+    WSDeque(const WSDeque&) = delete;
+
+    // disable copy assignment
+    WSDeque& operator=(const WSDeque&) = delete;
+
+    /**
+     * Push a task at the bottom. Owner only.
+     */
+    void push(PoolTask* x) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > a->cap - 1) {  // full, grow
+            Array* na = new Array(a->cap * 2);
+            for (int64_t i = t; i < b; i++) na->put(i, a->get(i));
+            arrays_.emplace_back(na);
+            array_.store(na, std::memory_order_release);
+            a = na;
+        }
+        a->put(b, x);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Pop a task at the bottom, or return nullptr if empty. Owner only.
+     */
+    PoolTask* pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        PoolTask* x = nullptr;
+        if (t <= b) {
+            x = a->get(b);
+            if (t == b) {  // the last one, race with thieves
+                if (!top_.compare_exchange_strong(t, t + 1,
+                                                  std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed))
+                    x = nullptr;
+                bottom_.store(b + 1, std::memory_order_relaxed);
+            }
+        } else {  // empty
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return x;
+    }
+
+    /**
+     * Steal a task at the top. Return nullptr if empty or if another thread
+     * won the race.
+     */
+    PoolTask* steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+        Array* a = array_.load(std::memory_order_acquire);
+        PoolTask* x = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed))
+            return nullptr;
+        return x;
+    }
+
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <=
+               top_.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Thread pool with a work-stealing deque per worker. Tasks submitted from a
+ * worker are pushed to its own deque and run in LIFO order, which keeps
+ * nested tasks hot in cache; idle workers steal from the top of a random
+ * victim's deque. Tasks submitted from other threads go through a shared
+ * queue. Same enqueue() API as ThreadPool.
+ *
+ * A task waiting for a nested task should use get(), which runs other tasks
+ * in the meantime instead of blocking the worker.
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t threads);
+    ~WorkStealingPool();
+
+    // disable copy constructor
+    WorkStealingPool(const WorkStealingPool&) = delete;
+
+    // disable copy assignment
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    template <class F, class... Args>
+    decltype(auto) enqueue(F&& f, Args&&... args);
+
+    // add a void() job without a future, for callers doing their own join
+    template <class F>
+    void post(F&& f) {
+        submit(new FnPoolTask<std::decay_t<F>>(std::forward<F>(f)));
+    }
+
+    /**
+     * Wait for the result of a future while running pending tasks.
+     */
+    template <class T>
+    T get(std::future<T>& fut);
+
+    /**
+     * Run one pending task if any. Return false if there is none.
+     */
+    bool runOne();
+
+    size_t size() const { return workers.size(); }
+
+private:
+    struct Worker {
+        WSDeque deque;
+        uint64_t seed;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Worker>> queues;
+
+    // tasks submitted from outside the pool
+    std::deque<PoolTask*> injected;
+    std::atomic<long> num_injected{0};
+    std::mutex inject_mutex;
+
+    // number of tasks queued but not yet taken
+    std::atomic<long> pending{0};
+
+    // idle workers sleep here
+    std::mutex sleep_mutex;
+    std::condition_variable condition;
+    std::atomic<int> sleeping{0};
+    std::atomic<bool> stop{false};
+
+private:
+    /**
+     * Index of the calling thread in this pool, or -1 if it is not a worker.
+     */
+    int workerIndex() const {
+        return current().pool == this ? current().index : -1;
+    }
+
+    struct Current {
+        const WorkStealingPool* pool = nullptr;
+        int index = -1;
+    };
+
+    static Current& current() {
+        static thread_local Current cur;
+        return cur;
+    }
+
+    void submit(PoolTask* task);
+    PoolTask* take(const int index);
+    PoolTask* stealFrom(const int index);
+    void run(const int index);
+};
+
+inline WorkStealingPool::WorkStealingPool(size_t threads) {
+    for (size_t i = 0; i < threads; ++i) {
+        queues.emplace_back(new Worker());
+        queues.back()->seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+    }
+    for (size_t i = 0; i < threads; ++i)
+        workers.emplace_back([this, i] { run(i); });
+}
+
+inline void WorkStealingPool::submit(PoolTask* task) {
+    int index = workerIndex();
+    if (index >= 0) {
+        queues[index]->deque.push(task);
+    } else {
+        std::lock_guard<std::mutex> lock(inject_mutex);
+        // don't allow enqueueing after stopping the pool
+        if (stop.load()) {
+            delete task;
+            throw std::runtime_error("enqueue on stopped WorkStealingPool");
+        }
+        injected.push_back(task);
+        num_injected.fetch_add(1);
+    }
+    pending.fetch_add(1);
+    if (sleeping.load() > 0) {
+        // the lock orders this wake-up after a sleeper's last check
+        { std::lock_guard<std::mutex> lock(sleep_mutex); }
+        condition.notify_one();
+    }
+}
+
+// add new work item to the pool
+template <class F, class... Args>
+decltype(auto) WorkStealingPool::enqueue(F&& f, Args&&... args) {
+    using return_type = std::invoke_result_t<F, Args...>;
+
+    std::packaged_task<return_type()> task(
+        std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+
+    std::future<return_type> res = task.get_future();
+    submit(new PackagedPoolTask<return_type>(std::move(task)));
+    return res;
+}
+
+inline PoolTask* WorkStealingPool::stealFrom(const int index) {
+    // xorshift to pick the first victim
+    uint64_t& x = queues[index]->seed;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    size_t n = queues.size(), start = x % n;
+    for (size_t k = 0; k < n; k++) {
+        size_t victim = (start + k) % n;
+        if ((int)victim == index) continue;
+        PoolTask* task = queues[victim]->deque.steal();
+        if (task != nullptr) return task;
+    }
+    return nullptr;
+}
+
+inline PoolTask* WorkStealingPool::take(const int index) {
+    PoolTask* task = nullptr;
+    if (index >= 0) task = queues[index]->deque.pop();
+    if (task == nullptr && num_injected.load() > 0) {
+        std::lock_guard<std::mutex> lock(inject_mutex);
+        if (!injected.empty()) {
+            task = injected.front();
+            injected.pop_front();
+            num_injected.fetch_sub(1);
+        }
+    }
+    if (task == nullptr && index >= 0) task = stealFrom(index);
+    if (task != nullptr) pending.fetch_sub(1);
+    return task;
+}
+
+inline bool WorkStealingPool::runOne() {
+    PoolTask* task = take(workerIndex());
+    if (task == nullptr) return false;
+    task->run();
+    delete task;
+    return true;
+}
+
+template <class T>
+T WorkStealingPool::get(std::future<T>& fut) {
+    while (fut.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        if (!runOne()) std::this_thread::yield();
+    return fut.get();
+}
+
+inline void WorkStealingPool::run(const int index) {
+    current().pool = this;
+    current().index = index;
+    for (;;) {
+        PoolTask* task = take(index);
+        if (task != nullptr) {
+            task->run();
+            delete task;
+            continue;
+        }
+        if (pending.load() > 0) {  // a steal lost a race, retry
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleeping.fetch_add(1);
+        condition.wait(lock,
+                       [this] { return stop.load() || pending.load() > 0; });
+        sleeping.fetch_sub(1);
+        if (stop.load() && pending.load() == 0) return;
+    }
+}
+
+// the destructor runs the remaining tasks, then joins all threads
+inline WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(inject_mutex);
+        stop.store(true);
+    }
+    { std::lock_guard<std::mutex> lock(sleep_mutex); }
+    condition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+}  // namespace syn
+
+#endif
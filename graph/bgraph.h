@@ -59,7 +59,10 @@ public:
         return *this;
     }
 
-    void save(const std::string& filename) const;
+    /**
+     * Save the graph in plain or compact format. load() detects the format.
+     */
+    void save(const std::string& filename, const bool compact = false) const;
     void load(const std::string& filename);
 
     bool isNode(const int id) const { return isNodeL(id) || isNodeR(id); }
@@ -79,9 +82,7 @@ public:
     const int getNodesR() const { return nodes_R_.size(); }
 
     const int getEdges() const {
-        int edges = 0;
-        for (const auto& p : nodes_L_) edges += p.second.getDeg();
-        return edges;
+        return sumNodes(nodes_L_, [](const Node& nd) { return nd.getDeg(); });
     }
 
     Node& getNodeL(const int id) { return nodes_L_.at(id); }
@@ -139,12 +140,13 @@ public:
      * including sorting and uniqing neighbors of each node increasingly.
      */
     void defrag() {
-        for (auto& p : nodes_L_) p.second.shrinkAndSort();
-        for (auto& p : nodes_R_) p.second.shrinkAndSort();
-        if (gtype_ == GraphType::SIMPLE) {
-            for (auto& p : nodes_L_) p.second.uniq();
-            for (auto& p : nodes_R_) p.second.uniq();
-        }
+        const bool uniq = gtype_ == GraphType::SIMPLE;
+        auto fn = [uniq](Node& nd) {
+            nd.shrinkAndSort();
+            if (uniq) nd.uniq();
+        };
+        forEachNode(nodes_L_, fn);
+        forEachNode(nodes_R_, fn);
     }
 
     void clear() {
@@ -0,0 +1,159 @@
+/**
+ * Copyright (C) by J.Z. (10/19/2026 19:20)
+ * Distributed under terms of the MIT license.
+ */
+
+#include "cgraph.h"
+
+namespace graph::comp {
+
+void CGraph::appendLists(const std::vector<std::pair<int, int>>& edges,
+                         std::string& dat, std::vector<size_t>& pos) const {
+    std::vector<int> nbrs;
+    auto it = edges.begin();
+    for (int id : ids_) {
+        nbrs.clear();
+        for (; it != edges.end() && it->first == id; ++it)
+            nbrs.push_back(it->second);
+        appendList(nbrs, id, dat, pos);
+    }
+}
+
+void CGraph::build(std::vector<std::pair<int, int>>& edges) {
+    clear();
+    std::sort(edges.begin(), edges.end());
+    if (gtype_ != GraphType::MULTI)
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    edges_ = edges.size();
+
+    ids_.reserve(edges.size());
+    for (auto& pr : edges) {
+        if (ids_.empty() || ids_.back() != pr.first) ids_.push_back(pr.first);
+    }
+    for (auto& pr : edges) ids_.push_back(pr.second);
+    std::sort(ids_.begin(), ids_.end());
+    ids_.erase(std::unique(ids_.begin(), ids_.end()), ids_.end());
+
+    appendLists(edges, out_dat_, out_pos_);
+    for (auto& pr : edges) std::swap(pr.first, pr.second);
+    std::sort(edges.begin(), edges.end());
+    appendLists(edges, in_dat_, in_pos_);
+    finish();
+}
+
+void CGraph::build(const std::string& out_edges_fnm,
+                   const std::string& in_edges_fnm) {
+    // edges of a file, grouped by the key column
+    struct EdgeStream {
+        ioutils::TSVParser ss;
+        const std::string& fnm;
+        const int key_col;
+        bool more = false, started = false;
+        int key = 0, nbr = 0;
+
+        EdgeStream(const std::string& filename, const int col)
+            : ss(filename), fnm(filename), key_col(col) {
+            advance();
+        }
+
+        void advance() {
+            if (!(more = ss.next())) return;
+            int k = ss.get<int>(key_col), v = ss.get<int>(1 - key_col);
+            if (started && (k < key || (k == key && v < nbr))) {
+                std::fprintf(stderr, "'%s' line %lu: edges are not sorted!\n",
+                             fnm.c_str(), ss.getLineNO());
+                exit(1);
+            }
+            started = true;
+            key = k;
+            nbr = v;
+        }
+    };
+
+    clear();
+    EdgeStream out(out_edges_fnm, 0), in(in_edges_fnm, 1);
+    std::vector<int> nbrs;
+    long in_edges = 0;
+    // move the list of node id from stream st to dat
+    auto take = [&](EdgeStream& st, const int id, std::string& dat,
+                    std::vector<size_t>& pos, long& num_edges) {
+        nbrs.clear();
+        for (; st.more && st.key == id; st.advance())
+            if (gtype_ == GraphType::MULTI || nbrs.empty() ||
+                nbrs.back() != st.nbr)
+                nbrs.push_back(st.nbr);
+        num_edges += nbrs.size();
+        appendList(nbrs, id, dat, pos);
+    };
+    while (out.more || in.more) {
+        int id = !out.more ? in.key
+                 : !in.more ? out.key
+                            : std::min(out.key, in.key);
+        ids_.push_back(id);
+        take(out, id, out_dat_, out_pos_, edges_);
+        take(in, id, in_dat_, in_pos_, in_edges);
+    }
+    if (in_edges != edges_) {
+        std::fprintf(stderr, "'%s' and '%s' have different edges!\n",
+                     out_edges_fnm.c_str(), in_edges_fnm.c_str());
+        exit(1);
+    }
+    finish();
+}
+
+void CGraph::finish() {
+    ids_.shrink_to_fit();
+    in_pos_.shrink_to_fit();
+    out_pos_.shrink_to_fit();
+    in_dat_.shrink_to_fit();
+    out_dat_.shrink_to_fit();
+    dense_ = ids_.empty() || (ids_.front() == 0 &&
+                              ids_.back() == (int)ids_.size() - 1);
+}
+
+void CGraph::clear() {
+    ids_.clear();
+    in_pos_.assign(1, 0);
+    out_pos_.assign(1, 0);
+    in_dat_.clear();
+    out_dat_.clear();
+    edges_ = 0;
+    dense_ = true;
+}
+
+void CGraph::save(const std::string& filename) const {
+    auto po = ioutils::getIOOut(filename);
+    po->save((long)ids_.size());
+    po->save(edges_);
+    po->writeArray(ids_.data(), ids_.size());
+    po->writeArray(in_pos_.data(), in_pos_.size());
+    po->writeArray(out_pos_.data(), out_pos_.size());
+    po->save(in_dat_);
+    po->save(out_dat_);
+}
+
+void CGraph::load(const std::string& filename) {
+    auto pi = ioutils::getIOIn(filename);
+    long n;
+    pi->load(n);
+    pi->load(edges_);
+    ids_.resize(n);
+    in_pos_.resize(n + 1);
+    out_pos_.resize(n + 1);
+    bool ok = pi->readArray(ids_.data(), n) == (size_t)n &&
+              pi->readArray(in_pos_.data(), n + 1) == (size_t)n + 1 &&
+              pi->readArray(out_pos_.data(), n + 1) == (size_t)n + 1;
+    if (ok) {
+        in_dat_.resize(in_pos_[n]);
+        out_dat_.resize(out_pos_[n]);
+        ok = pi->read(&in_dat_[0], in_dat_.size()) == in_dat_.size() &&
+             pi->read(&out_dat_[0], out_dat_.size()) == out_dat_.size();
+    }
+    if (!ok) {
+        std::fprintf(stderr, "Corrupted graph file '%s'!\n", filename.c_str());
+        exit(1);
+    }
+    finish();
+}
+
+} /* namespace graph::comp */
@@ -0,0 +1,342 @@
+/**
+ * Copyright (C) by J.Z. (10/19/2026 19:20)
+ * Distributed under terms of the MIT license.
+ */
+
+#ifndef __CGRAPH_H__
+#define __CGRAPH_H__
+
+#include <stdexcept>
+
+#include "comm.h"
+
+namespace graph::comp {
+
+/**
+ * Forward iterator over a compressed neighbor list, which is the number of
+ * neighbors followed by the gaps between consecutive neighbors (see
+ * ioutils::putDeltas). Neighbors are decoded on the fly.
+ */
+class NbrIter {
+private:
+    const char *p_ = nullptr, *next_ = nullptr;  // current and next gap
+    int left_ = 0;                               // # of neighbors left
+    uint32_t val_ = 0;                           // current neighbor
+
+private:
+    void decode() {
+        if (left_ == 0) return;
+        uint32_t gap;
+        next_ = ioutils::getVarint(p_, gap);
+        val_ += (uint32_t)ioutils::unzigzag(gap);
+    }
+
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef int value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const int* pointer;
+    typedef int reference;
+
+    NbrIter() {}
+
+    /**
+     * Begin iterator of the list at p, of the node with given ID.
+     */
+    NbrIter(const char* p, const int id) : val_(id) {
+        uint32_t n;
+        p_ = ioutils::getVarint(p, n);
+        left_ = n;
+        decode();
+    }
+
+    /**
+     * End iterator of a list ending at p.
+     */
+    explicit NbrIter(const char* p) : p_(p) {}
+
+    int operator*() const { return (int)val_; }
+
+    NbrIter& operator++() {
+        p_ = next_;
+        left_--;
+        decode();
+        return *this;
+    }
+
+    NbrIter operator++(int) {
+        NbrIter tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const NbrIter& o) const { return p_ == o.p_; }
+    bool operator!=(const NbrIter& o) const { return p_ != o.p_; }
+};
+
+class CGraph;
+
+/**
+ * A read-only view of a node in a CGraph.
+ */
+class Node {
+private:
+    const CGraph* graph_ = nullptr;
+    int idx_ = 0;  // index of the node in the graph
+
+private:
+    const char* inList() const;
+    const char* outList() const;
+    static int getLen(const char* list) {
+        uint32_t n;
+        ioutils::getVarint(list, n);
+        return n;
+    }
+    static bool contains(NbrIter first, const NbrIter& last, const int v) {
+        // neighbors are sorted
+        for (; first != last && *first <= v; ++first)
+            if (*first == v) return true;
+        return false;
+    }
+
+public:
+    Node() {}
+    Node(const CGraph* graph, const int idx) : graph_(graph), idx_(idx) {}
+
+    int getID() const;
+    int getInDeg() const { return getLen(inList()); }
+    int getOutDeg() const { return getLen(outList()); }
+    int getDeg() const { return getInDeg() + getOutDeg(); }
+
+    int getNbrID(const NbrIter& it) const { return *it; }
+
+    bool isInNbr(const int v) const {
+        return contains(beginInNbr(), endInNbr(), v);
+    }
+    bool isOutNbr(const int v) const {
+        return contains(beginOutNbr(), endOutNbr(), v);
+    }
+    bool isNbr(const int v) const { return isInNbr(v) || isOutNbr(v); }
+
+    NbrIter beginInNbr() const { return NbrIter(inList(), getID()); }
+    NbrIter endInNbr() const;
+    NbrIter beginOutNbr() const { return NbrIter(outList(), getID()); }
+    NbrIter endOutNbr() const;
+
+    // same as dir::Node, where beginNbr() iterates over out-neighbors
+    NbrIter beginNbr() const { return beginOutNbr(); }
+    NbrIter endNbr() const { return endOutNbr(); }
+    void nextNbr(NbrIter& ni) const { ++ni; }
+
+    std::vector<int> getInNbrs() const {
+        return std::vector<int>(beginInNbr(), endInNbr());
+    }
+    std::vector<int> getOutNbrs() const {
+        return std::vector<int>(beginOutNbr(), endOutNbr());
+    }
+};
+
+/**
+ * Iterator over the nodes of a CGraph in increasing order of node IDs. As for
+ * other graphs, it->first is the node ID and it->second is the node.
+ */
+class NodeIter {
+private:
+    std::pair<int, Node> cur_;
+    const CGraph* graph_ = nullptr;
+    int idx_ = 0;
+
+private:
+    void update();
+
+public:
+    NodeIter() {}
+    NodeIter(const CGraph* graph, const int idx) : graph_(graph), idx_(idx) {
+        update();
+    }
+
+    const std::pair<int, Node>& operator*() const { return cur_; }
+    const std::pair<int, Node>* operator->() const { return &cur_; }
+
+    NodeIter& operator++() {
+        idx_++;
+        update();
+        return *this;
+    }
+
+    NodeIter operator++(int) {
+        NodeIter tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const NodeIter& o) const { return idx_ == o.idx_; }
+    bool operator!=(const NodeIter& o) const { return idx_ != o.idx_; }
+};
+
+/**
+ * Compressed, read-only directed graph for graphs that do not fit in memory
+ * as a DGraph. Nodes are kept in increasing order of IDs. The in- and
+ * out-neighbor lists of each node are sorted and stored as varint coded gaps
+ * (see ioutils::putDeltas) in two byte arrays, so a node takes a few bytes for
+ * its ID and offsets, and an edge one or two bytes in each direction when
+ * node IDs are local. Neighbors are decoded on the fly while iterating, at
+ * the cost of some CPU cycles.
+ *
+ * The graph can be used by DirBFS, SCCVisitor and HyperANF. Looking up a node
+ * by ID is a binary search, unless IDs are 0, 1, ..., n-1.
+ */
+class CGraph {
+public:
+    typedef comp::NbrIter NbrIter;
+    typedef comp::NodeIter NodeIter;
+    typedef comp::Node Node;
+
+private:
+    GraphType gtype_;
+    std::vector<int> ids_;                   // sorted node IDs
+    bool dense_ = true;                      // ids_[i] == i for all i
+    std::vector<size_t> in_pos_, out_pos_;   // list offsets, n + 1 each
+    std::string in_dat_, out_dat_;           // encoded lists
+    long edges_ = 0;
+
+    friend class comp::Node;
+    friend class comp::NodeIter;
+
+private:
+    /**
+     * Append the sorted list nbrs of node id to dat.
+     */
+    static void appendList(const std::vector<int>& nbrs, const int id,
+                           std::string& dat, std::vector<size_t>& pos) {
+        ioutils::putDeltas(nbrs, id, dat);
+        pos.push_back(dat.size());
+    }
+
+    /**
+     * Encode lists of edges sorted by sources, into lists of sources.
+     */
+    void appendLists(const std::vector<std::pair<int, int>>& edges,
+                     std::string& dat, std::vector<size_t>& pos) const;
+
+    void finish();
+
+public:
+    CGraph(const GraphType gtype = GraphType::SIMPLE) : gtype_(gtype) {
+        clear();
+    }
+
+    /**
+     * Compress a graph having beginNI() and in/out neighbor iterators, e.g., a
+     * DGraph.
+     */
+    template <class Graph>
+    void build(const Graph& graph);
+
+    /**
+     * Build the graph from an edge list. This only needs memory for the edges
+     * besides the graph itself. Edges are sorted in place; parallel edges are
+     * removed unless the graph is a multi-graph.
+     */
+    void build(std::vector<std::pair<int, int>>& edges);
+
+    /**
+     * Build the graph by streaming two edge list files of the same edges, one
+     * sorted by sources then destinations and one sorted by destinations then
+     * sources, e.g., by "sort -n -k1,1 -k2,2" and "sort -n -k2,2 -k1,1". Both
+     * have the source in the first column. Only the neighbors of one node are
+     * held uncompressed at a time, so graphs larger than the memory as edge
+     * lists can be built. Parallel edges are removed unless the graph is a
+     * multi-graph.
+     */
+    void build(const std::string& out_edges_fnm,
+               const std::string& in_edges_fnm);
+
+    void save(const std::string& filename) const;
+    void load(const std::string& filename);
+
+    const int getNodes() const { return ids_.size(); }
+    const int getEdges() const { return edges_; }
+
+    /**
+     * Bytes used by the graph.
+     */
+    size_t getBytes() const {
+        return ids_.size() * sizeof(int) +
+               (in_pos_.size() + out_pos_.size()) * sizeof(size_t) +
+               in_dat_.size() + out_dat_.size();
+    }
+
+    /**
+     * Index of node id, or -1 if id is not in the graph.
+     */
+    int getIndex(const int id) const {
+        if (dense_) return id >= 0 && id < (int)ids_.size() ? id : -1;
+        auto it = std::lower_bound(ids_.begin(), ids_.end(), id);
+        return it != ids_.end() && *it == id ? it - ids_.begin() : -1;
+    }
+
+    bool isNode(const int id) const { return getIndex(id) >= 0; }
+
+    bool isEdge(const int src, const int dst) const {
+        return isNode(src) && isNode(dst) && getNode(src).isOutNbr(dst);
+    }
+
+    const Node getNode(const int id) const {
+        int idx = getIndex(id);
+        if (idx < 0) throw std::out_of_range("CGraph: no such node");
+        return Node(this, idx);
+    }
+    const Node operator[](const int id) const { return getNode(id); }
+
+    NodeIter beginNI() const { return NodeIter(this, 0); }
+    NodeIter endNI() const { return NodeIter(this, ids_.size()); }
+
+    void clear();
+}; /* CGraph */
+
+template <class Graph>
+void CGraph::build(const Graph& graph) {
+    clear();
+    for (auto it = graph.beginNI(); it != graph.endNI(); ++it)
+        ids_.push_back(it->first);
+    std::sort(ids_.begin(), ids_.end());
+    std::vector<int> nbrs;
+    for (int id : ids_) {
+        const auto& nd = graph[id];
+        nbrs.assign(nd.beginInNbr(), nd.endInNbr());
+        std::sort(nbrs.begin(), nbrs.end());
+        appendList(nbrs, id, in_dat_, in_pos_);
+        nbrs.assign(nd.beginOutNbr(), nd.endOutNbr());
+        std::sort(nbrs.begin(), nbrs.end());
+        appendList(nbrs, id, out_dat_, out_pos_);
+        edges_ += nbrs.size();
+    }
+    finish();
+}
+
+inline const char* Node::inList() const {
+    return graph_->in_dat_.data() + graph_->in_pos_[idx_];
+}
+
+inline const char* Node::outList() const {
+    return graph_->out_dat_.data() + graph_->out_pos_[idx_];
+}
+
+inline int Node::getID() const { return graph_->ids_[idx_]; }
+
+inline NbrIter Node::endInNbr() const {
+    return NbrIter(graph_->in_dat_.data() + graph_->in_pos_[idx_ + 1]);
+}
+
+inline NbrIter Node::endOutNbr() const {
+    return NbrIter(graph_->out_dat_.data() + graph_->out_pos_[idx_ + 1]);
+}
+
+inline void NodeIter::update() {
+    if (idx_ < (int)graph_->ids_.size())
+        cur_ = std::make_pair(graph_->ids_[idx_], Node(graph_, idx_));
+}
+
+} /* namespace graph::comp */
+#endif /* __CGRAPH_H__ */
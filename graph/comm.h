@@ -18,7 +18,10 @@
 #include <iterator>
 
 #include "../io/ioutils.h"
+#include "../io/varint.h"
 #include "../adv/rngutils.h"
+#include "../adv/parallel.h"
+#include "../adv/pipeline.h"
 
 namespace graph {
 
@@ -26,6 +29,89 @@ enum class GraphType {
     SIMPLE,  // simple graph
     MULTI,   // multi-graph (two nodes may have multiple edges between them)
 };
+
+// Leading int of the nodes of a graph saved in compact format. In the plain
+// format the leading int is the number of nodes, which is never negative.
+static const int COMPACT_MAGIC = INT_MIN + 0x4347;
+
+// Neighbor lists at least this long are sorted by radix sort.
+static const size_t RADIX_SORT_MIN = 1 << 10;
+
+/**
+ * LSD radix sort of ints, one byte per pass. Passes where all values have the
+ * same byte are skipped, so lists of small node IDs take two or three passes.
+ */
+inline void radixSort(std::vector<int>& vec) {
+    const size_t n = vec.size();
+    if (n < 2) return;
+    // a local buffer: pool threads live long, and a cached one would keep
+    // the size of the longest list ever sorted
+    std::vector<uint32_t> buf(n);
+    // as unsigned with the sign bit flipped, negative values come first
+    uint32_t *src = (uint32_t*)vec.data(), *dst = buf.data();
+    for (size_t i = 0; i < n; i++) src[i] ^= 0x80000000u;
+    for (int shift = 0; shift < 32; shift += 8) {
+        size_t cnt[257] = {0};
+        for (size_t i = 0; i < n; i++) cnt[((src[i] >> shift) & 0xFF) + 1]++;
+        if (cnt[((src[0] >> shift) & 0xFF) + 1] == n) continue;
+        for (int d = 0; d < 256; d++) cnt[d + 1] += cnt[d];
+        for (size_t i = 0; i < n; i++)
+            dst[cnt[(src[i] >> shift) & 0xFF]++] = src[i];
+        std::swap(src, dst);
+    }
+    if (src != (uint32_t*)vec.data())
+        std::copy(src, src + n, (uint32_t*)vec.data());
+    for (int& v : vec) v ^= INT_MIN;
+}
+
+/**
+ * Sort a neighbor list increasingly.
+ */
+inline void sortNbrs(std::vector<int>& nbrs) {
+    if (nbrs.size() < RADIX_SORT_MIN)
+        std::sort(nbrs.begin(), nbrs.end());
+    else
+        radixSort(nbrs);
+}
+
+// Node maps smaller than this are processed serially.
+static const size_t PARALLEL_MIN_NODES = 1 << 16;
+
+/**
+ * Run fn(node) for each node of a node map, in parallel by buckets of the map
+ * when it is large.
+ */
+template <class Map, class F>
+void forEachNode(Map& nodes, F&& fn) {
+    if (nodes.size() < PARALLEL_MIN_NODES) {
+        for (auto& pr : nodes) fn(pr.second);
+        return;
+    }
+    syn::parallel_for(size_t(0), nodes.bucket_count(), 0, [&](size_t b) {
+        for (auto it = nodes.begin(b); it != nodes.end(b); ++it) fn(it->second);
+    });
+}
+
+/**
+ * Return the sum of fn(node) over the nodes of a node map.
+ */
+template <class Map, class F>
+long sumNodes(const Map& nodes, F&& fn) {
+    if (nodes.size() < PARALLEL_MIN_NODES) {
+        long sum = 0;
+        for (auto& pr : nodes) sum += fn(pr.second);
+        return sum;
+    }
+    return syn::parallel_reduce(
+        size_t(0), nodes.bucket_count(), 0, 0L,
+        [&](size_t b) {
+            long sum = 0;
+            for (auto it = nodes.begin(b); it != nodes.end(b); ++it)
+                sum += fn(it->second);
+            return sum;
+        },
+        [](long a, long b) { return a + b; });
+}
 }
 
 #endif /* __COMM_H__ */
@@ -8,28 +8,30 @@
 namespace graph::dir {
 
 void Node::save(std::unique_ptr<ioutils::IOOut>& po) const {
-    po->save(id_);                            // id
-    po->save((int)in_nbrs_.size());           // in-deg
-    for (int nbr : in_nbrs_) po->save(nbr);   // in-neighbors
-    po->save((int)out_nbrs_.size());          // out-deg
-    for (int nbr : out_nbrs_) po->save(nbr);  // out-neighbors
+    po->save(id_);        // id
+    po->save(in_nbrs_);   // in-deg, in-neighbors
+    po->save(out_nbrs_);  // out-deg, out-neighbors
 }
 
 void Node::load(std::unique_ptr<ioutils::IOIn>& pi) {
-    int deg, nbr;
-    pi->load(id_);          // id
-    pi->load(deg);          // in-deg
-    in_nbrs_.reserve(deg);  // in-neighbors
-    for (int d = 0; d < deg; d++) {
-        pi->load(nbr);
-        in_nbrs_.push_back(nbr);
-    }
-    pi->load(deg);           // out-deg
-    out_nbrs_.reserve(deg);  // out-neighbors
-    for (int d = 0; d < deg; d++) {
-        pi->load(nbr);
-        out_nbrs_.push_back(nbr);
-    }
+    pi->load(id_);        // id
+    pi->load(in_nbrs_);   // in-deg, in-neighbors
+    pi->load(out_nbrs_);  // out-deg, out-neighbors
+}
+
+void Node::encode(std::string& buf, const int prev_id) const {
+    ioutils::putVarint(ioutils::zigzag((int)((uint32_t)id_ - prev_id)), buf);
+    ioutils::putDeltas(in_nbrs_, id_, buf);
+    ioutils::putDeltas(out_nbrs_, id_, buf);
+}
+
+const char* Node::decode(const char* p, const char* end, const int prev_id) {
+    uint32_t gap;
+    if ((p = ioutils::getVarint(p, end, gap)) == nullptr) return nullptr;
+    id_ = (int)((uint32_t)prev_id + (uint32_t)ioutils::unzigzag(gap));
+    p = ioutils::getDeltas(p, end, id_, in_nbrs_);
+    if (p == nullptr) return nullptr;
+    return ioutils::getDeltas(p, end, id_, out_nbrs_);
 }
 
 void Node::addInNbr(const int nbr) {
@@ -66,22 +68,14 @@ std::vector<int> Node::getNbrs() const {
     return std::vector<int>(nbrset.begin(), nbrset.end());
 }
 
-void DGraph::save(const std::string& filename) const {
+void DGraph::save(const std::string& filename, const bool compact) const {
     auto po = ioutils::getIOOut(filename);
-    po->save((int)nodes_.size());                // total number of nodes
-    for (auto& pr : nodes_) pr.second.save(po);  // each node
+    saveNodes(nodes_, po, compact);
 }
 
 void DGraph::load(const std::string& filename) {
     auto pi = ioutils::getIOIn(filename);
-    int num_nodes;
-    pi->load(num_nodes);  // total number of nodes
-    nodes_.reserve(num_nodes);
-    for (int n = 0; n < num_nodes; n++) {
-        Node node;
-        node.load(pi);
-        nodes_[node.getID()] = std::move(node);
-    }
+    loadNodes(nodes_, pi);
 }
 
 void DGraph::addEdgeFast(const int src, const int dst) {
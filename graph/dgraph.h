@@ -50,6 +50,12 @@ public:
     void save(std::unique_ptr<ioutils::IOOut>& po) const override;
     void load(std::unique_ptr<ioutils::IOIn>& pi) override;
 
+    // compact format, see saveNodes(); the ID is coded as the gap from
+    // prev_id, the ID of the previous node. decode() returns nullptr if the
+    // record is corrupted.
+    void encode(std::string& buf, const int prev_id) const;
+    const char* decode(const char* p, const char* end, const int prev_id);
+
     int getDeg() const override { return in_nbrs_.size() + out_nbrs_.size(); }
     int getInDeg() const override { return in_nbrs_.size(); }
     int getOutDeg() const override { return out_nbrs_.size(); }
@@ -111,8 +117,8 @@ public:
     void shrinkAndSort() {
         in_nbrs_.shrink_to_fit();
         out_nbrs_.shrink_to_fit();
-        std::sort(in_nbrs_.begin(), in_nbrs_.end());
-        std::sort(out_nbrs_.begin(), out_nbrs_.end());
+        sortNbrs(in_nbrs_);
+        sortNbrs(out_nbrs_);
     }
 
     void uniq() {
@@ -182,7 +188,14 @@ public:
                 std::move(o)));
     }
 
-    void save(const std::string& filename) const override;
+    void save(const std::string& filename) const override {
+        save(filename, false);
+    }
+
+    /**
+     * Save the graph in plain or compact format. load() detects the format.
+     */
+    void save(const std::string& filename, const bool compact) const;
     void load(const std::string& filename) override;
 
     bool isEdge(const int src, const int dst) const override {
@@ -191,9 +204,7 @@ public:
     }
 
     const int getEdges() const override {
-        int edges = 0;
-        for (const auto& p : nodes_) edges += p.second.getOutDeg();
-        return edges;
+        return sumNodes(nodes_, [](const Node& nd) { return nd.getOutDeg(); });
     }
 
     int sampleInNbr(int id) const { return getNode(id).sampleInNbr(rng_); }
@@ -10,12 +10,62 @@
 
 namespace graph {
 
+/**
+ * Load a graph from a TSV edge list. With more than one thread, the file is
+ * loaded by a pipeline: one thread reads (and decompresses) blocks of lines,
+ * `threads` threads parse them, and one thread adds the edges to the graph.
+ * As with one thread, a malformed line throws std::invalid_argument.
+ */
 template <class Graph>
 Graph loadEdgeList(const std::string& edges_fnm,
-                   const GraphType gtype = GraphType::SIMPLE) {
+                   const GraphType gtype = GraphType::SIMPLE,
+                   const int threads = 1) {
     Graph G(gtype);
-    ioutils::TSVParser ss(edges_fnm);
-    while (ss.next()) G.addEdge(ss.get<int>(0), ss.get<int>(1));
+    if (threads <= 1) {
+        ioutils::TSVParser ss(edges_fnm);
+        while (ss.next()) G.addEdge(ss.get<int>(0), ss.get<int>(1));
+        G.defrag();
+        return G;
+    }
+
+    const size_t BLOCK_SIZE = 1 << 20;
+    auto pin = ioutils::getIOIn(edges_fnm);
+    if (pin == nullptr) {
+        std::cout << "File: " << edges_fnm << " does not exist!" << std::endl;
+        std::exit(-1);
+    }
+    std::string rest;  // partial last line of the previous block
+    syn::Pipeline pipe(2 * threads);
+    pipe.source<std::string>("read",
+                             [&](std::string& block) {
+                                 block.swap(rest);
+                                 rest.clear();
+                                 while (true) {
+                                     size_t len = block.size();
+                                     block.resize(len + BLOCK_SIZE);
+                                     size_t num_read =
+                                         pin->read(&block[len], BLOCK_SIZE);
+                                     block.resize(len + num_read);
+                                     if (num_read == 0) return !block.empty();
+                                     // keep the partial last line for later
+                                     size_t nl = block.rfind('\n');
+                                     if (nl == std::string::npos) continue;
+                                     rest.assign(block, nl + 1);
+                                     block.resize(nl + 1);
+                                     return true;
+                                 }
+                             })
+        .then("parse", threads,
+              [](std::string& block) {
+                  std::vector<std::vector<int>> cols;
+                  ioutils::parseIntBlock(block, {0, 1}, cols);
+                  return cols;
+              })
+        .sink("build", [&G](std::vector<std::vector<int>>& cols) {
+            for (size_t i = 0; i < cols[0].size(); i++)
+                G.addEdge(cols[0][i], cols[1][i]);
+        });
+    pipe.wait();
     G.defrag();
     return G;
 }
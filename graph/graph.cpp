@@ -8,3 +8,4 @@
 #include "ugraph.cpp"
 #include "dgraph.cpp"
 #include "bgraph.cpp"
+#include "cgraph.cpp"
@@ -11,6 +11,7 @@
 #include "ugraph.h"
 #include "dgraph.h"
 #include "bgraph.h"
+#include "cgraph.h"
 
 // #include "dyn_dgraph.h"
 // #include "network.h"
@@ -21,5 +22,6 @@
 #include "cncom.h"
 #include "hyperanf.h"
 #include "subgraph.h"
+#include "sample.h"
 
 #endif /* __GRAPH_H__ */
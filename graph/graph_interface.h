@@ -97,11 +97,14 @@ public:
     /**
      * Optimize the graph data structure for the purpose of fast access,
      * including sorting and uniqing neighbors of each node increasingly.
+     * Nodes are processed in parallel on large graphs.
      */
     virtual void defrag() {
-        for (auto& p : nodes_) p.second.shrinkAndSort();
-        if (gtype_ == GraphType::SIMPLE)
-            for (auto& p : nodes_) p.second.uniq();
+        const bool uniq = gtype_ == GraphType::SIMPLE;
+        forEachNode(nodes_, [uniq](Node& nd) {
+            nd.shrinkAndSort();
+            if (uniq) nd.uniq();
+        });
     }
 
     // iterators
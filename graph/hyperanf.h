@@ -10,6 +10,7 @@
 #include "dgraph.h"
 #include "cncom.h"
 #include "../adv/hll.h"
+#include "../adv/bulk_rng.h"
 
 namespace graph {
 
@@ -23,13 +24,16 @@ namespace graph {
  */
 class HyperANF {
 protected:
+    // number of counters merged by a job when estimating for a node set
+    static const long MERGE_GRAIN = 256;
+
     // p: precision, m = 2^p: number of registers in a HLL counter
     // units_per_counter = m / 8: # of uint64 integers per HLL counter
     int p_, m_, units_per_counter_;
     std::vector<uint64_t> bits_;  // HLL counters are stored in a bit-vector
     std::unordered_map<int, int> cc_bitpos_, nd_cc_;
 
-    rngutils::default_rng rng;
+    rngutils::bulk_rng rng;
 
 protected:
     /**
@@ -66,15 +70,20 @@ protected:
 
     /**
      * Generate HLL counter for a CC at pos. If a CC contains num nodes, then
-     * need to add num random numbers.
+     * need to add num random numbers, which are drawn in blocks.
      */
     inline void genHLLCounter(const int pos, const int num = 1) {
         uint8_t* reg_array = (uint8_t*)(bits_.data() + pos);
-        for (int n = 0; n < num; n++) {
-            uint64_t x = rng.randint<uint64_t>();
-            int reg_idx = (x >> (64 - p_)) & ((1 << p_) - 1);
-            uint8_t reg_rho = hll::clz8(x << p_) + 1;
-            if (reg_rho > reg_array[reg_idx]) reg_array[reg_idx] = reg_rho;
+        uint64_t rands[rngutils::bulk_rng::BLOCK];
+        for (int done = 0; done < num; done += rngutils::bulk_rng::BLOCK) {
+            int len = std::min(num - done, (int)rngutils::bulk_rng::BLOCK);
+            rng.fill(rands, len);
+            for (int n = 0; n < len; n++) {
+                uint64_t x = rands[n];
+                int reg_idx = (x >> (64 - p_)) & ((1 << p_) - 1);
+                uint8_t reg_rho = hll::clz8(x << p_) + 1;
+                if (reg_rho > reg_array[reg_idx]) reg_array[reg_idx] = reg_rho;
+            }
         }
     }
 
@@ -124,8 +133,25 @@ public:
     template <class InputIt>
     double estimate(InputIt first, InputIt last) const {
         std::vector<uint64_t> tmp_bits(units_per_counter_, 0);
-        for (; first != last; ++first)
-            mergeCounter(tmp_bits.data(), getCounterPos(*first));
+        if constexpr (std::is_same<typename std::iterator_traits<
+                                       InputIt>::iterator_category,
+                                   std::random_access_iterator_tag>::value) {
+            // merge counters of chunks of nodes in parallel, then the chunks
+            std::mutex mutex;
+            syn::parallel_chunks(
+                syn::defaultPool(), first, last, MERGE_GRAIN,
+                [&](long, InputIt lo, const InputIt hi) {
+                    std::vector<uint64_t> bits(units_per_counter_, 0);
+                    for (; lo != hi; ++lo)
+                        mergeCounter(bits.data(), getCounterPos(*lo));
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for (int k = 0; k < units_per_counter_; k++)
+                        hll::max(tmp_bits[k], bits[k]);
+                });
+        } else {
+            for (; first != last; ++first)
+                mergeCounter(tmp_bits.data(), getCounterPos(*first));
+        }
         return hll::count((uint8_t*)tmp_bits.data(), m_);
     }
 
@@ -69,5 +69,97 @@ public:
     virtual NbrIter endOutNbr() const { return endNbr(); }
 
 }; /* INode */
+
+/**
+ * Save nodes, in plain format as [#nodes][node]... with Node::save(), or in
+ * compact format as [COMPACT_MAGIC][#nodes][#bytes][bytes]... with
+ * Node::encode(), where each chunk of bytes holds the records of many nodes.
+ * Nodes are saved in ascending order of IDs, and each ID is coded as the gap
+ * from the previous ID in the chunk (from 0 for the first). Neighbor lists are
+ * coded as gaps too, so sorted neighbor lists (after defrag()) take a fraction
+ * of the plain format.
+ */
+template <class Node>
+void saveNodes(const std::unordered_map<int, Node>& nodes,
+               std::unique_ptr<ioutils::IOOut>& po, const bool compact) {
+    if (!compact) {
+        po->save((int)nodes.size());               // total number of nodes
+        for (auto& pr : nodes) pr.second.save(po);  // each node
+        return;
+    }
+    const size_t CHUNK_BYTES = 1 << 20;
+    po->save(COMPACT_MAGIC);
+    po->save((int)nodes.size());
+    std::string buf;
+    auto flush = [&]() {
+        po->save((int)buf.size());
+        po->write(buf.data(), buf.size());
+        buf.clear();
+    };
+    std::vector<int> ids;
+    ids.reserve(nodes.size());
+    for (auto& pr : nodes) ids.push_back(pr.first);
+    std::sort(ids.begin(), ids.end());
+    int prev_id = 0;
+    for (int id : ids) {
+        nodes.at(id).encode(buf, prev_id);
+        prev_id = id;
+        if (buf.size() >= CHUNK_BYTES) {
+            flush();
+            prev_id = 0;
+        }
+    }
+    if (!buf.empty()) flush();
+}
+
+/**
+ * Load nodes saved by saveNodes() in either format.
+ */
+template <class Node>
+void loadNodes(std::unordered_map<int, Node>& nodes,
+               std::unique_ptr<ioutils::IOIn>& pi) {
+    int num_nodes = 0;
+    pi->load(num_nodes);  // total number of nodes, or COMPACT_MAGIC
+    if (num_nodes != COMPACT_MAGIC) {
+        if (num_nodes < 0) {
+            std::fprintf(stderr, "Corrupted graph file!\n");
+            exit(1);
+        }
+        nodes.reserve(num_nodes);
+        for (int n = 0; n < num_nodes; n++) {
+            Node node;
+            node.load(pi);
+            nodes[node.getID()] = std::move(node);
+        }
+        return;
+    }
+    num_nodes = 0;
+    pi->load(num_nodes);
+    if (num_nodes < 0) {
+        std::fprintf(stderr, "Corrupted compact graph file!\n");
+        exit(1);
+    }
+    nodes.reserve(num_nodes);
+    std::string buf;
+    for (int n = 0, nbytes; n < num_nodes;) {
+        nbytes = 0;
+        pi->load(nbytes);
+        if (nbytes > 0) buf.resize(nbytes);
+        if (nbytes <= 0 || pi->read(&buf[0], nbytes) < (size_t)nbytes) {
+            std::fprintf(stderr, "Corrupted compact graph file!\n");
+            exit(1);
+        }
+        int prev_id = 0;
+        for (const char *p = buf.data(), *end = p + nbytes; p < end; n++) {
+            Node node;
+            if ((p = node.decode(p, end, prev_id)) == nullptr || n >= num_nodes) {
+                std::fprintf(stderr, "Corrupted compact graph file!\n");
+                exit(1);
+            }
+            prev_id = node.getID();
+            nodes[prev_id] = std::move(node);
+        }
+    }
+}
 } /* namespace graph */
 #endif /* __NODE_INTERFACE_H__ */
@@ -0,0 +1,169 @@
+/**
+ * Copyright (C) by J.Z. (10/19/2026 14:20)
+ * Distributed under terms of the MIT license.
+ */
+
+#ifndef __SAMPLE_H__
+#define __SAMPLE_H__
+
+#include "comm.h"
+#include "dgraph.h"
+#include "subgraph.h"
+
+namespace graph {
+
+/**
+ * Uniformly sample num edges from an edge list file in one pass, using a
+ * reservoir. Only the sampled edges are kept in memory, so the file may be
+ * much larger than the memory. Every line is still split into fields, but the
+ * fields of lines that cannot enter the reservoir are not converted to ints.
+ *
+ * For a SIMPLE graph, duplicated edges in the sample are merged, so the
+ * returned graph may have fewer than num edges.
+ */
+template <class Graph>
+Graph sampleEdges(const std::string& edges_fnm, const int num,
+                  const GraphType gtype = GraphType::SIMPLE) {
+    rngutils::default_rng rng;
+    rngutils::Reservoir<std::pair<int, int>> rsv(num, rng);
+    ioutils::TSVParser ss(edges_fnm);
+    while (ss.next()) {
+        if (rsv.wanted())
+            rsv.add(std::make_pair(ss.get<int>(0), ss.get<int>(1)));
+        else
+            rsv.skip();
+    }
+    Graph G(gtype);
+    for (auto& e : rsv.getSamples()) G.addEdgeFast(e.first, e.second);
+    G.defrag();
+    return G;
+}
+
+/**
+ * A node filter keeping each node with probability ratio. Membership is
+ * decided by hashing the node ID with a random salt, so no node set needs to
+ * be stored and the same node is always decided the same way.
+ */
+class NodeFilter {
+private:
+    uint64_t salt_, threshold_;
+
+public:
+    NodeFilter(const double ratio, const uint64_t salt) : salt_(salt) {
+        threshold_ = ratio >= 1 ? UINT64_MAX
+                                : (uint64_t)(ratio * 18446744073709551616.0);
+    }
+
+    /**
+     * splitmix64 finalizer
+     */
+    static uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    bool operator()(const int id) const {
+        return mix((uint64_t)(uint32_t)id ^ salt_) < threshold_;
+    }
+};
+
+/**
+ * Sample each node with probability ratio and return the subgraph induced by
+ * the sampled nodes, reading the edge list file in one pass. Sampled nodes
+ * whose edges all go to non-sampled nodes are kept as isolated nodes.
+ *
+ * Require: Graph provides addNode(), i.e., DGraph or UGraph.
+ */
+template <class Graph>
+Graph sampleInducedSubgraph(const std::string& edges_fnm, const double ratio,
+                            const GraphType gtype = GraphType::SIMPLE) {
+    rngutils::default_rng rng;
+    NodeFilter keep(ratio, rng.randint<uint64_t>());
+    Graph G(gtype);
+    ioutils::TSVParser ss(edges_fnm);
+    while (ss.next()) {
+        int src = ss.get<int>(0), dst = ss.get<int>(1);
+        bool ks = keep(src), kd = keep(dst);
+        if (ks && kd)
+            G.addEdgeFast(src, dst);
+        else if (ks)
+            G.addNode(src);
+        else if (kd)
+            G.addNode(dst);
+    }
+    G.defrag();
+    return G;
+}
+
+/**
+ * Forest fire sampling on a loaded graph. Starting from a random seed node,
+ * each burned node burns x unvisited out-neighbors, where x is geometrically
+ * distributed with mean fwd_prob / (1 - fwd_prob), and bwd_ratio * x
+ * unvisited in-neighbors. When the fire dies out, a new random seed is
+ * chosen, until num_nodes nodes are burned. Return the subgraph induced by the
+ * burned nodes.
+ *
+ * Refer to J. Leskovec and C. Faloutsos. Sampling from Large Graphs. KDD,
+ * 2006.
+ *
+ * Require: Graph is directed, i.e., DGraph; num_nodes >= 0; 0 <= fwd_prob < 1.
+ */
+template <class Graph>
+Graph forestFire(const Graph& G, const int num_nodes,
+                 const double fwd_prob = 0.7, const double bwd_ratio = 0.0) {
+    static_assert(std::is_same<Graph, dir::DGraph>::value,
+                  "forestFire requires a DGraph");
+    if (num_nodes < 0) {
+        std::fprintf(stderr, "forestFire: num_nodes must be >= 0!\n");
+        exit(1);
+    }
+    if (!(fwd_prob >= 0 && fwd_prob < 1)) {
+        std::fprintf(stderr, "forestFire: fwd_prob must be in [0, 1)!\n");
+        exit(1);
+    }
+    rngutils::default_rng rng;
+    size_t target = std::min(num_nodes, G.getNodes());
+    std::unordered_set<int> burned;
+    std::vector<int> nodes, cands;
+    nodes.reserve(target);
+
+    // burn at most num unvisited nodes in [first, last)
+    auto spread = [&](const auto& nd, auto first, auto last, const int num,
+                      std::queue<int>& queue) {
+        cands.clear();
+        for (auto ni = first; ni != last; ++ni) {
+            int v = nd.getNbrID(ni);
+            if (burned.find(v) == burned.end()) cands.push_back(v);
+        }
+        size_t n = std::min((size_t)num, cands.size());
+        for (size_t i = 0; i < n && nodes.size() < target; i++) {
+            std::swap(cands[i], cands[rng.uniform(i, cands.size() - 1)]);
+            burned.insert(cands[i]);
+            nodes.push_back(cands[i]);
+            queue.push(cands[i]);
+        }
+    };
+
+    while (nodes.size() < target) {
+        int seed = G.sampleNode();
+        if (!burned.insert(seed).second) continue;
+        nodes.push_back(seed);
+        std::queue<int> queue;
+        queue.push(seed);
+        while (!queue.empty() && nodes.size() < target) {
+            int u = queue.front();
+            queue.pop();
+            const auto& nd = G[u];
+            int x = rng.geometric(1 - fwd_prob);
+            spread(nd, nd.beginOutNbr(), nd.endOutNbr(), x, queue);
+            int y = (int)std::round(bwd_ratio * x);
+            if (y > 0) spread(nd, nd.beginInNbr(), nd.endInNbr(), y, queue);
+        }
+    }
+    return getSubgraph(G, nodes);
+}
+
+}  // namespace graph
+
+#endif /* __SAMPLE_H__ */
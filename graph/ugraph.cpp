@@ -8,20 +8,25 @@
 namespace graph::undir {
 
 void Node::save(std::unique_ptr<ioutils::IOOut>& po) const {
-    po->save(id_);                        // id
-    po->save((int)nbrs_.size());          // deg
-    for (int nbr : nbrs_) po->save(nbr);  // neighbors
+    po->save(id_);    // id
+    po->save(nbrs_);  // deg, neighbors
 }
 
 void Node::load(std::unique_ptr<ioutils::IOIn>& pi) {
-    int deg, nbr;
-    pi->load(id_);       // id
-    pi->load(deg);       // deg
-    nbrs_.reserve(deg);  // neighbors
-    for (int d = 0; d < deg; d++) {
-        pi->load(nbr);
-        nbrs_.push_back(nbr);
-    }
+    pi->load(id_);    // id
+    pi->load(nbrs_);  // deg, neighbors
+}
+
+void Node::encode(std::string& buf, const int prev_id) const {
+    ioutils::putVarint(ioutils::zigzag((int)((uint32_t)id_ - prev_id)), buf);
+    ioutils::putDeltas(nbrs_, id_, buf);
+}
+
+const char* Node::decode(const char* p, const char* end, const int prev_id) {
+    uint32_t gap;
+    if ((p = ioutils::getVarint(p, end, gap)) == nullptr) return nullptr;
+    id_ = (int)((uint32_t)prev_id + (uint32_t)ioutils::unzigzag(gap));
+    return ioutils::getDeltas(p, end, id_, nbrs_);
 }
 
 void Node::addNbr(const int nbr) {
@@ -35,22 +40,14 @@ void Node::addNbr(const int nbr) {
     }
 }
 
-void UGraph::save(const std::string& filename) const {
+void UGraph::save(const std::string& filename, const bool compact) const {
     auto po = ioutils::getIOOut(filename);
-    po->save((int)nodes_.size());                // total number of nodes
-    for (auto& pr : nodes_) pr.second.save(po);  // each node
+    saveNodes(nodes_, po, compact);
 }
 
 void UGraph::load(const std::string& filename) {
     auto pi = ioutils::getIOIn(filename);
-    int num_nodes;
-    pi->load(num_nodes);  // total number of nodes
-    nodes_.reserve(num_nodes);
-    for (int n = 0; n < num_nodes; n++) {
-        Node node;
-        node.load(pi);
-        nodes_[node.getID()] = std::move(node);
-    }
+    loadNodes(nodes_, pi);
 }
 
 void UGraph::addEdge(const int src, const int dst) {
@@ -46,6 +46,12 @@ public:
     void save(std::unique_ptr<ioutils::IOOut>& po) const override;
     void load(std::unique_ptr<ioutils::IOIn>& pi) override;
 
+    // compact format, see saveNodes(); the ID is coded as the gap from
+    // prev_id, the ID of the previous node. decode() returns nullptr if the
+    // record is corrupted.
+    void encode(std::string& buf, const int prev_id) const;
+    const char* decode(const char* p, const char* end, const int prev_id);
+
     int getDeg() const override { return nbrs_.size(); }
 
     int getNbrID(const NbrIter& it) const override { return *it; }
@@ -80,7 +86,7 @@ public:
 
     void shrinkAndSort() {
         nbrs_.shrink_to_fit();
-        std::sort(nbrs_.begin(), nbrs_.end());
+        sortNbrs(nbrs_);
     }
 
     void uniq() {
@@ -143,7 +149,14 @@ public:
                 std::move(o)));
     }
 
-    void save(const std::string& filename) const override;
+    void save(const std::string& filename) const override {
+        save(filename, false);
+    }
+
+    /**
+     * Save the graph in plain or compact format. load() detects the format.
+     */
+    void save(const std::string& filename, const bool compact) const;
     void load(const std::string& filename) override;
 
     bool isEdge(const int src, const int dst) const override {
@@ -152,9 +165,7 @@ public:
     }
 
     const int getEdges() const override {
-        int edges = 0;
-        for (const auto& p : nodes_) edges += p.second.getDeg();
-        return edges / 2;
+        return sumNodes(nodes_, [](const Node& nd) { return nd.getDeg(); }) / 2;
     }
 
     int sampleNbr(int id) const { return getNode(id).sampleNbr(rng_); }
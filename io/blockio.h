@@ -0,0 +1,286 @@
+/**
+ * Copyright (C) by J.Z. (10/19/2026 15:02)
+ * Distributed under terms of the MIT license.
+ */
+
+#ifndef __BLOCKIO_H__
+#define __BLOCKIO_H__
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "iobase.h"
+#include "../adv/synqueue.h"
+
+namespace ioutils {
+
+/**
+ * Base class of readers that decode the input block by block, e.g., LZ4In and
+ * GZipIn. A subclass only implements readBlock(), which decodes the next block
+ * into a given buffer; reading bytes and lines out of the current block is
+ * done here, with memchr/memcpy over whole spans instead of byte by byte.
+ *
+ * With read-ahead enabled, blocks are decoded by a background thread, which
+ * keeps up to K decoded blocks ready, so that decoding overlaps with the
+ * consumer. The thread starts on the first read. A subclass must call
+ * resetBlock() before it releases anything used by readBlock(), e.g., in
+ * close().
+ */
+class BlockIn : public IOIn {
+private:
+    /**
+     * K + 1 block buffers circulate between the decoding thread and the
+     * consumer through two queues: 'free' holds buffers to decode into, and
+     * 'full' holds decoded blocks in order. An empty block marks the end, and
+     * a negative index in 'free' tells the thread to stop.
+     */
+    struct ReadAhead {
+        std::vector<std::unique_ptr<char[]>> bufs;
+        std::vector<size_t> lens;
+        syn::SynQueue<int> free, full;
+        std::thread thread;
+        int cur = -1;      // buffer held by the consumer
+        bool eos = false;  // set by the thread when it reaches the end
+        bool done = false;  // set by the consumer when it reaches the end
+    };
+
+    std::unique_ptr<char[]> buf_;
+    size_t capacity_;
+
+    int read_ahead_ = 0;
+    std::unique_ptr<ReadAhead> ra_;
+
+    const char* blk_ = nullptr;  // current block
+    size_t blk_len_ = 0, blk_pos_ = 0;
+    size_t blk_start_ = 0;  // position of the current block in the stream
+
+    // holds a line that spans more than one block
+    std::string line_buf_;
+
+protected:
+    /**
+     * Decode the next block into dst, which has capacity bytes. Return the
+     * number of bytes decoded, or 0 if there are no more blocks.
+     */
+    virtual size_t readBlock(char* dst, const size_t capacity) = 0;
+
+    /**
+     * Discard the current and read-ahead blocks, e.g., before the underlying
+     * file is closed, reopened or repositioned. The decoding thread, if any,
+     * is stopped. The next block starts at position pos of the stream.
+     */
+    void resetBlock(const size_t pos = 0) {
+        stopReadAhead();
+        ra_.reset();
+        blk_ = nullptr;
+        blk_len_ = blk_pos_ = 0;
+        blk_start_ = pos;
+    }
+
+    void startReadAhead() {
+        if (!ra_) {
+            ra_.reset(new ReadAhead());
+            for (int i = 0; i <= read_ahead_; i++) {
+                ra_->bufs.emplace_back(new char[capacity_]);
+                ra_->lens.push_back(0);
+                if (i < read_ahead_) ra_->free.push(i);
+            }
+        }
+        // eos is only read once the thread has been joined
+        if (ra_->thread.joinable() || ra_->eos) return;
+        ra_->thread = std::thread([this, ra = ra_.get()] {
+            while (true) {
+                int i = ra->free.pop();
+                if (i < 0) return;
+                ra->lens[i] = readBlock(ra->bufs[i].get(), capacity_);
+                if (ra->lens[i] == 0) ra->eos = true;
+                ra->full.push(i);
+                if (ra->eos) return;
+            }
+        });
+    }
+
+    /**
+     * Stop the decoding thread. Blocks already decoded are kept, and the
+     * thread is started again on demand.
+     */
+    void stopReadAhead() {
+        if (ra_ && ra_->thread.joinable()) {
+            ra_->free.push(-1);
+            ra_->thread.join();
+        }
+    }
+
+    bool fill() {
+        blk_start_ += blk_len_;
+        if (read_ahead_ > 0) {
+            startReadAhead();
+            if (ra_->done) return false;
+            if (ra_->cur >= 0) ra_->free.push(ra_->cur);
+            int i = ra_->cur = ra_->full.pop();
+            blk_ = ra_->bufs[i].get();
+            blk_len_ = ra_->lens[i];
+            blk_pos_ = 0;
+            if (blk_len_ == 0) ra_->done = true;
+            return blk_len_ > 0;
+        }
+        if (!buf_) buf_.reset(new char[capacity_]);
+        blk_ = buf_.get();
+        blk_len_ = readBlock(buf_.get(), capacity_);
+        blk_pos_ = 0;
+        return blk_len_ > 0;
+    }
+
+public:
+    BlockIn(const size_t capacity) : capacity_(capacity) {}
+
+    virtual ~BlockIn() { stopReadAhead(); }
+
+    // the decoding thread of other is stopped, and resumed by this reader
+    BlockIn(BlockIn&& other)
+        : buf_(std::move(other.buf_)),
+          capacity_(other.capacity_),
+          read_ahead_(other.read_ahead_),
+          ra_((other.stopReadAhead(), std::move(other.ra_))),
+          blk_(other.blk_),
+          blk_len_(other.blk_len_),
+          blk_pos_(other.blk_pos_),
+          blk_start_(other.blk_start_),
+          line_buf_(std::move(other.line_buf_)) {
+        other.resetBlock();
+    }
+
+    BlockIn& operator=(BlockIn&& other) {
+        stopReadAhead();
+        other.stopReadAhead();
+        buf_ = std::move(other.buf_);
+        capacity_ = other.capacity_;
+        read_ahead_ = other.read_ahead_;
+        ra_ = std::move(other.ra_);
+        blk_ = other.blk_;
+        blk_len_ = other.blk_len_;
+        blk_pos_ = other.blk_pos_;
+        blk_start_ = other.blk_start_;
+        line_buf_ = std::move(other.line_buf_);
+        other.resetBlock();
+        return *this;
+    }
+
+    /**
+     * Decode up to 'blocks' blocks ahead in a background thread; 0 disables
+     * read-ahead. Blocks decoded ahead cannot be given back, so once reading
+     * with read-ahead has started, the change takes effect only after the
+     * reader is closed or reopened.
+     */
+    void setReadAhead(const int blocks) {
+        if (!ra_) read_ahead_ = blocks;
+    }
+
+    int getReadAhead() const { return read_ahead_; }
+
+    // position in the decoded stream
+    size_t tell() const { return blk_start_ + blk_pos_; }
+
+    /**
+     * Skip at most len bytes. Return the number of bytes skipped.
+     */
+    size_t skip(const size_t len) {
+        size_t num_skipped = 0;
+        while (num_skipped < len && !eof()) {
+            size_t num = std::min(len - num_skipped, blk_len_ - blk_pos_);
+            blk_pos_ += num;
+            num_skipped += num;
+        }
+        return num_skipped;
+    }
+
+    bool eof() override {
+        if (blk_pos_ < blk_len_) return false;
+        return !fill();
+    }
+
+    /**
+     * Whole blocks are decoded directly into 'data' when the current block
+     * is used up and read-ahead is off.
+     */
+    size_t read(const void* data, const size_t len) override {
+        if (len <= 0 || data == nullptr) return 0;
+        char* dst = (char*)data;
+        size_t num_read = 0;
+        while (num_read < len) {
+            if (blk_pos_ == blk_len_ && read_ahead_ == 0 &&
+                len - num_read >= capacity_) {
+                blk_start_ += blk_len_;
+                blk_len_ = blk_pos_ = 0;
+                size_t num = readBlock(dst + num_read, capacity_);
+                if (num == 0) break;
+                blk_start_ += num;
+                num_read += num;
+                continue;
+            }
+            if (eof()) break;
+            size_t num = std::min(len - num_read, blk_len_ - blk_pos_);
+            std::memcpy(dst + num_read, blk_ + blk_pos_, num);
+            blk_pos_ += num;
+            num_read += num;
+        }
+        return num_read;
+    }
+
+    size_t readLine(const void* data, const size_t len) override {
+        if (len <= 0 || data == nullptr) return 0;
+        char* dst = (char*)data;
+        size_t num_read = 0;
+        while (num_read < len - 1 && !eof()) {
+            size_t num = std::min(len - 1 - num_read, blk_len_ - blk_pos_);
+            const char* src = blk_ + blk_pos_;
+            const char* nl = (const char*)std::memchr(src, '\n', num);
+            if (nl != nullptr) num = nl - src + 1;
+            std::memcpy(dst + num_read, src, num);
+            blk_pos_ += num;
+            num_read += num;
+            if (nl != nullptr) break;
+        }
+        dst[num_read] = '\0';
+        return num_read;
+    }
+
+    /**
+     * A line within one block is returned as a view into the block, and is
+     * only copied if it spans several blocks.
+     */
+    bool readLine(std::string_view& line) override {
+        if (eof()) return false;
+        const char* src = blk_ + blk_pos_;
+        size_t num = blk_len_ - blk_pos_;
+        const char* nl = (const char*)std::memchr(src, '\n', num);
+        if (nl != nullptr) {
+            num = nl - src + 1;
+            blk_pos_ += num;
+            line = std::string_view(src, num);
+            return true;
+        }
+        line_buf_.assign(src, num);
+        blk_pos_ += num;
+        while (!eof()) {
+            src = blk_ + blk_pos_;
+            num = blk_len_ - blk_pos_;
+            nl = (const char*)std::memchr(src, '\n', num);
+            if (nl != nullptr) num = nl - src + 1;
+            line_buf_.append(src, num);
+            blk_pos_ += num;
+            if (nl != nullptr) break;
+        }
+        line = line_buf_;
+        return true;
+    }
+};
+
+}  // namespace ioutils
+
+#endif /* __BLOCKIO_H__ */
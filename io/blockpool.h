@@ -0,0 +1,65 @@
+/**
+ * Copyright (C) by J.Z. (10/19/2026 16:05)
+ * Distributed under terms of the MIT license.
+ */
+
+#ifndef __BLOCKPOOL_H__
+#define __BLOCKPOOL_H__
+
+#include <deque>
+#include <future>
+#include <string>
+
+#include "../adv/thread_pool.h"
+
+namespace ioutils {
+
+/**
+ * Encode blocks concurrently on a thread pool, and hand the encoded blocks to
+ * a sink in the order they were submitted, e.g., compressing the blocks of a
+ * file in parallel while writing them sequentially.
+ *
+ * At most 2 * threads blocks are in flight; submitting more waits for the
+ * oldest one, which bounds the memory used.
+ */
+class BlockPool {
+private:
+    syn::ThreadPool pool_;
+    size_t max_pending_;
+    std::deque<std::future<std::string>> pending_;
+
+private:
+    template <class Sink>
+    void popFront(Sink& sink) {
+        std::string block = pending_.front().get();
+        pending_.pop_front();
+        sink(block);
+    }
+
+public:
+    BlockPool(const int threads)
+        : pool_(threads), max_pending_(2 * (size_t)threads) {}
+
+    /**
+     * Run job, a callable returning the encoded block as a std::string, on
+     * the pool. Encoded blocks that are due are passed to sink, a callable
+     * taking a const std::string&, on the calling thread.
+     */
+    template <class Job, class Sink>
+    void submit(Job&& job, Sink&& sink) {
+        while (pending_.size() >= max_pending_) popFront(sink);
+        pending_.push_back(pool_.enqueue(std::forward<Job>(job)));
+    }
+
+    /**
+     * Wait for all submitted blocks, and pass them to sink in order.
+     */
+    template <class Sink>
+    void flush(Sink&& sink) {
+        while (!pending_.empty()) popFront(sink);
+    }
+};
+
+}  // namespace ioutils
+
+#endif /* __BLOCKPOOL_H__ */
@@ -2,11 +2,31 @@
 
 namespace ioutils {
 
-const size_t GZipOut::MAX_BUF_SIZE = 4 * 1024;
-
-GZipOut::GZipOut(const std::string& filename) : buf_sz_(0) {
-    zip_wr_ = popen(getCmd(filename).c_str(), "w");
+// window bits of a gzip stream with a 32KB window
+static const int GZIP_WBITS = 15 + 16;
+
+const size_t GZipOut::MAX_BUF_SIZE = 128 * 1024;
+
+GZipOut::GZipOut(const std::string& filename, const bool append,
+                 const int threads, const int level)
+    : level_(level), buf_sz_(0) {
+    output_ = std::fopen(filename.c_str(), append ? "ab" : "wb");
+    if (output_ == nullptr) {
+        std::fprintf(stderr, "Open file '%s' failed!\n", filename.c_str());
+        exit(1);
+    }
     buf_ = new char[MAX_BUF_SIZE];
+    if (threads > 1) {
+        pool_.reset(new BlockPool(threads));
+    } else {
+        std::memset(&strm_, 0, sizeof(strm_));
+        if (deflateInit2(&strm_, level, Z_DEFLATED, GZIP_WBITS, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK) {
+            std::fprintf(stderr, "Initialize deflate failed!\n");
+            exit(1);
+        }
+        out_buf_.reset(new char[MAX_BUF_SIZE]);
+    }
 }
 
 GZipOut::~GZipOut() {
@@ -14,16 +34,56 @@ GZipOut::~GZipOut() {
     if (buf_ != NULL) delete[] buf_;
 }
 
-void GZipOut::flush() {
-    fwrite(buf_, 1, buf_sz_, zip_wr_);
+static std::string compressMember(const std::string& data, const int level) {
+    z_stream strm;
+    std::memset(&strm, 0, sizeof(strm));
+    deflateInit2(&strm, level, Z_DEFLATED, GZIP_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::string member(deflateBound(&strm, data.size()), '\0');
+    strm.next_in = (Bytef*)data.data();
+    strm.avail_in = data.size();
+    strm.next_out = (Bytef*)&member[0];
+    strm.avail_out = member.size();
+    deflate(&strm, Z_FINISH);
+    member.resize(member.size() - strm.avail_out);
+    deflateEnd(&strm);
+    return member;
+}
+
+void GZipOut::writeMember(const std::string& member) {
+    fwrite(member.data(), 1, member.size(), output_);
+}
+
+void GZipOut::flush(const bool finish) {
+    if (pool_) {
+        if (buf_sz_ > 0)
+            pool_->submit(
+                [data = std::string(buf_, buf_sz_), level = level_]() {
+                    return compressMember(data, level);
+                },
+                [this](const std::string& member) { writeMember(member); });
+        if (finish)
+            pool_->flush(
+                [this](const std::string& member) { writeMember(member); });
+        buf_sz_ = 0;
+        return;
+    }
+    strm_.next_in = (Bytef*)buf_;
+    strm_.avail_in = buf_sz_;
+    do {
+        strm_.next_out = (Bytef*)out_buf_.get();
+        strm_.avail_out = MAX_BUF_SIZE;
+        deflate(&strm_, finish ? Z_FINISH : Z_NO_FLUSH);
+        fwrite(out_buf_.get(), 1, MAX_BUF_SIZE - strm_.avail_out, output_);
+    } while (strm_.avail_out == 0);
     buf_sz_ = 0;
 }
 
 void GZipOut::close() {
-    if (buf_sz_ != 0) flush();
-    if (zip_wr_ != NULL) {
-        pclose(zip_wr_);
-        zip_wr_ = NULL;
+    if (output_ != NULL) {
+        flush(true);
+        if (!pool_) deflateEnd(&strm_);
+        fclose(output_);
+        output_ = NULL;
     }
 }
 
@@ -39,70 +99,68 @@ void GZipOut::write(const void* dat, const size_t len) {
     }
 }
 
-std::string GZipOut::getCmd(const std::string& filename) {
-    std::string base, name, ext;
-    strutils::splitFilename(filename, base, name, ext);
-    return fmt::format("7za a -y -bd -si{} {} > /dev/null", name.c_str(),
-                       filename.c_str());
-}
-
 // GZipIn
-const size_t GZipIn::MAX_BUF_SIZE = 32 * 1024;
-
-GZipIn::GZipIn(const std::string& filename) {
-    zip_rd_ = popen(getCmd(filename).c_str(), "r");
-    buf_ = new char[MAX_BUF_SIZE];
-    fill();
-}
-
-GZipIn::~GZipIn() {
-    if (zip_rd_ != NULL) pclose(zip_rd_);
-    if (buf_ != NULL) delete[] buf_;
-}
-
-bool GZipIn::eof() {
-    if (num_read_ < buf_sz_) return false;
-    return !fill();
+const size_t GZipIn::MAX_BUF_SIZE = 128 * 1024;
+
+GZipIn::GZipIn(const std::string& filename, const int read_ahead)
+    : BlockIn(MAX_BUF_SIZE) {
+    input_ = std::fopen(filename.c_str(), "rb");
+    if (input_ == nullptr) {
+        std::fprintf(stderr, "Open file '%s' failed!\n", filename.c_str());
+        exit(1);
+    }
+    std::memset(&strm_, 0, sizeof(strm_));
+    // accept gzip and zlib headers
+    if (inflateInit2(&strm_, 15 + 32) != Z_OK) {
+        std::fprintf(stderr, "Initialize inflate failed!\n");
+        exit(1);
+    }
+    in_buf_.reset(new char[MAX_BUF_SIZE]);
+    setReadAhead(read_ahead);
 }
 
-bool GZipIn::fill() {
-    buf_sz_ = fread(buf_, 1, MAX_BUF_SIZE, zip_rd_);
-    num_read_ = 0;
-    return buf_sz_ > 0;
-}
+GZipIn::~GZipIn() { close(); }
 
-size_t GZipIn::read(const void* dat, const size_t len) {
-    if (len <= 0 || dat == nullptr) return 0;
-    size_t num_read = 0, num_to_read = 0;
-    while (!eof() && num_read < len) {
-        num_to_read = std::min(len - num_read, buf_sz_ - num_read_);
-        std::memcpy((char*)dat + num_read, buf_ + num_read_, num_to_read);
-        num_read += num_to_read;
-        num_read_ += num_to_read;
+void GZipIn::close() {
+    resetBlock();
+    if (input_ != nullptr) {
+        inflateEnd(&strm_);
+        fclose(input_);
+        input_ = nullptr;
     }
-    return num_read;
 }
 
-size_t GZipIn::readLine(const void* dat, const size_t len) {
-    size_t num_read = 0, num_to_read;
-    while (!eof() && num_read < len - 1) {
-        num_to_read = std::min(len - num_read, buf_sz_ - num_read_);
-        char* src_ptr = buf_ + num_read_;
-        char* dst_ptr = (char*)dat + num_read;
-        for (size_t i = 0; i < num_to_read; i++) {
-            *dst_ptr++ = *src_ptr++;
-            num_read++;
-            num_read_++;
-            if (*(dst_ptr - 1) == '\n') break;
+size_t GZipIn::readBlock(char* dat, const size_t capacity) {
+    if (input_ == nullptr || finished_) return 0;
+    strm_.next_out = (Bytef*)dat;
+    strm_.avail_out = capacity;
+    while (strm_.avail_out > 0) {
+        if (strm_.avail_in == 0) {
+            strm_.next_in = (Bytef*)in_buf_.get();
+            strm_.avail_in = fread(in_buf_.get(), 1, MAX_BUF_SIZE, input_);
+            if (strm_.avail_in == 0) break;
+        }
+        size_t avail_out = strm_.avail_out;
+        int ret = inflate(&strm_, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            // another gzip member may follow
+            inflateReset(&strm_);
+            member_end_ = true;
+        } else if (ret == Z_DATA_ERROR && member_end_) {
+            // bytes after a complete member that do not start a new one,
+            // e.g., zero padding, end the input
+            std::fprintf(stderr, "Ignored trailing data after gzip member.\n");
+            finished_ = true;
+            break;
+        } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            std::fprintf(stderr, "Decompress failed: %s\n",
+                         strm_.msg != nullptr ? strm_.msg : "unknown error");
+            exit(1);
+        } else if (strm_.avail_out < avail_out) {
+            member_end_ = false;  // in a new member
         }
-        if (*(dst_ptr - 1) == '\n') break;
     }
-    *((char*)dat + num_read) = '\0';
-    return num_read;
-}
-
-std::string GZipIn::getCmd(const std::string& filename) const {
-    return fmt::format("7za e -y -bd -so {} 2> /dev/null", filename.c_str());
+    return capacity - strm_.avail_out;
 }
 
 }  // end namespace ioutils
@@ -1,91 +1,98 @@
 #ifndef __GZIPIO_H__
 #define __GZIPIO_H__
-// Compressed input and output streams. 7za.exe or 7z.exe must be in the path
-// (http://www.7-zip.org)
+// Compressed input and output streams in gzip format, using zlib.
 //
-// 7za.exe is a stand-alone program, which supports
-//   -- extraction:  .gz, .7z, .rar, .zip, .cab, .arj. bzip2
-//   -- compression: .7z
-// 7z.exe uses DLLs in folders Codecs and Formats
-//   -- extraction:  .gz, .7z, .rar, .zip, .cab, .arj. bzip2
-//   -- compression: .gz, .7z, .rar, .zip, .cab, .arj. bzip2
-
-// TODO: make sure 7za-full is installed on linux
+// GZipOut compresses either as a single deflate stream, or, with more than one
+// thread, as a sequence of independently compressed gzip members (like pigz),
+// which is also a valid gzip file. GZipIn reads both, and any concatenation of
+// gzip members.
 
 #include <cstdio>
 #include <cstring>
 
+#include <memory>
 #include <string>
-#include <unordered_set>
 
-#include "iobase.h"
-#include "../str/strutils.h"
+#include <zlib.h>
+
+#include "blockio.h"
+#include "blockpool.h"
 
 namespace ioutils {
 
 class GZipOut : public IOOut {
 private:
     static const size_t MAX_BUF_SIZE;
+    int level_;
     size_t buf_sz_;
     char* buf_;
-    FILE* zip_wr_;
+    FILE* output_ = nullptr;
+
+    // single-threaded mode: one deflate stream
+    z_stream strm_;
+    std::unique_ptr<char[]> out_buf_;
+
+    // multi-threaded mode: each buffer is compressed as a gzip member
+    std::unique_ptr<BlockPool> pool_;
 
 private:
-    void flush();
+    /**
+     * Compress the buffered data. In single-threaded mode, the compressed data
+     * is written when the output buffer is full, or when finishing.
+     */
+    void flush(const bool finish = false);
+
+    void writeMember(const std::string& member);
 
 public:
-    GZipOut(const std::string& filename);
+    /**
+     * level: zlib compression level, from 1 (fastest) to 9 (best).
+     * threads: if larger than 1, compress in parallel.
+     */
+    GZipOut(const std::string& filename, const bool append = false,
+            const int threads = 1, const int level = Z_DEFAULT_COMPRESSION);
     ~GZipOut();
 
+    // disable copy constructor
+    GZipOut(const GZipOut&) = delete;
+
+    // disable copy assignment
+    GZipOut& operator=(const GZipOut&) = delete;
+
     /**
      * Write `len` data from source `dat` to buffer. If the buffer is full, data
-     * will be flushed to disk.
+     * will be compressed.
      */
     void write(const void* dat, const size_t len) override;
 
     void close() override;
-
-    std::string getCmd(const std::string& filename);
 };
 
-class GZipIn : public IOIn {
+class GZipIn : public BlockIn {
 private:
     static const size_t MAX_BUF_SIZE;
 
-    size_t num_read_, buf_sz_;
-    char* buf_;
-    FILE* zip_rd_;
+    FILE* input_ = nullptr;
+    z_stream strm_;
+    std::unique_ptr<char[]> in_buf_;
+    // a member just ended, so what follows is a new member or trailing data
+    bool member_end_ = false;
+    bool finished_ = false;  // trailing data was found; no more input
 
-private:
-    bool fill();
+protected:
+    size_t readBlock(char* dat, const size_t capacity) override;
 
 public:
-    GZipIn(const std::string& filename);
+    GZipIn(const std::string& filename, const int read_ahead = 0);
     ~GZipIn();
 
-    void close() override{};
-
-    bool eof() override;
-
-    /**
-     * Read `len` data into target buffer `dat`. The method does not allocate
-     * space for target buffer `dat`. It assumes the target buffer `dat` has at
-     * least `len` space.
-     */
-    size_t read(const void* dat, const size_t len) override;
+    // disable copy constructor
+    GZipIn(const GZipIn&) = delete;
 
-    /**
-     * Read characters until a newline ('\n') is encountered. If a newline
-     * character is not encountered in the first (len - 1) bytes, then the
-     * excess characters are discarded. The returned string placed in 'data' is
-     * null-terminated and includes the newline character if it was read in the
-     * first (n - 1) bytes. The function return value is the number of bytes
-     * placed in buffer (which includes the newline character if encountered,
-     * but excludes the terminating null byte).
-     */
-    size_t readLine(const void* data, const size_t len) override;
+    // disable copy assignment
+    GZipIn& operator=(const GZipIn&) = delete;
 
-    std::string getCmd(const std::string& zip_fnm) const;
+    void close() override;
 };
 }  // namespace ioutils
 #endif /* __GZIPIO_H__ */
@@ -5,6 +5,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace ioutils {
@@ -32,11 +34,21 @@ public:
     }
     virtual void save(const std::vector<int>& vec) {
         save((int)vec.size());
-        for (int v : vec) save(v);
+        writeArray(vec.data(), vec.size());
     }
     virtual void save(const std::vector<double>& vec) {
         save((int)vec.size());
-        for (double v : vec) save(v);
+        writeArray(vec.data(), vec.size());
+    }
+
+    /**
+     * Write n elements of a trivially copyable type in one bulk write.
+     */
+    template <typename T>
+    void writeArray(const T* arr, const size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "writeArray requires a trivially copyable type");
+        write(arr, n * sizeof(T));
     }
 };
 
@@ -64,27 +76,45 @@ public:
      **/
     virtual size_t readLine(const void* data, const size_t len) = 0;
 
+    /**
+     * Read the next line, of any length, into 'line', which includes the
+     * newline character if present. The view refers to an internal buffer
+     * of the reader and is valid until the next read operation. Return false
+     * if there are no more lines.
+     */
+    virtual bool readLine(std::string_view& line) = 0;
+
     virtual void load(int& val) { read(&val, sizeof(int)); }
     virtual void load(long& val) { read(&val, sizeof(long)); }
     virtual void load(double& val) { read(&val, sizeof(double)); }
-    virtual void load(std::vector<int>& vec) {
-        int total, val;
-        load(total);
-        vec.reserve(total);
-        for (int i = 0; i < total; ++i) {
-            load(val);
-            vec.push_back(val);
-        }
+    virtual void load(std::vector<int>& vec) { loadVector(vec); }
+    virtual void load(std::vector<double>& vec) { loadVector(vec); }
+
+    /**
+     * Read at most n elements of a trivially copyable type in one bulk read.
+     * Return the number of elements read.
+     */
+    template <typename T>
+    size_t readArray(T* arr, const size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "readArray requires a trivially copyable type");
+        return read(arr, n * sizeof(T)) / sizeof(T);
     }
-    virtual void load(std::vector<double>& vec) {
-        int total;
-        double val;
-        load(total);
-        vec.reserve(total);
-        for (int i = 0; i < total; ++i) {
-            load(val);
-            vec.push_back(val);
+
+private:
+    /**
+     * Append a vector saved as its length followed by its elements.
+     */
+    template <typename T>
+    void loadVector(std::vector<T>& vec) {
+        int total = 0;
+        size_t size = vec.size();
+        if (read(&total, sizeof(int)) == sizeof(int) && total >= 0) {
+            vec.resize(size + total);
+            if (readArray(vec.data() + size, total) == (size_t)total) return;
         }
+        std::fprintf(stderr, "Corrupted vector in file!\n");
+        exit(1);
     }
 };
 
@@ -117,6 +147,8 @@ public:
 class NormIn : public IOIn {
 private:
     FILE* fr_ = nullptr;
+    char* line_buf_ = nullptr;
+    size_t line_cap_ = 0;
 
 public:
     NormIn(const std::string& filename) {
@@ -127,7 +159,10 @@ public:
         }
     }
 
-    virtual ~NormIn() { close(); }
+    virtual ~NormIn() {
+        close();
+        free(line_buf_);
+    }
 
     void close() override {
         if (fr_ != nullptr) {
@@ -149,6 +184,13 @@ public:
         else
             return 0;
     }
+
+    bool readLine(std::string_view& line) override {
+        ssize_t len = getline(&line_buf_, &line_cap_, fr_);
+        if (len <= 0) return false;
+        line = std::string_view(line_buf_, len);
+        return true;
+    }
 };
 }  // namespace ioutils
 
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
 #include "ioutils.h"
 
 namespace ioutils {
@@ -5,7 +9,6 @@ namespace ioutils {
 bool isGZip(const std::string& filename) {
     std::unordered_set<std::string> gzip_exts;
     gzip_exts.insert(".gz");
-    gzip_exts.insert(".zip");
     std::string base, name, ext;
     strutils::splitFilename(filename, base, name, ext);
     return gzip_exts.find(ext) != gzip_exts.end();
@@ -21,13 +24,21 @@ bool isLZ4(const std::string& filename) {
     return true;
 }
 
+bool isZstd(const std::string& filename) {
+    std::string base, name, ext;
+    strutils::splitFilename(filename, base, name, ext);
+    return ext == ".zst";
+}
+
 std::unique_ptr<IOOut> getIOOut(const std::string& filename,
-                                const bool append) {
+                                const bool append, const int threads) {
     osutils::rmfile(filename);
     if (isGZip(filename))
-        return std::make_unique<GZipOut>(filename);
+        return std::make_unique<GZipOut>(filename, append, threads);
     else if (isLZ4(filename))
-        return std::make_unique<LZ4Out>(filename.c_str(), append);
+        return std::make_unique<LZ4Out>(filename.c_str(), append, threads);
+    else if (isZstd(filename))
+        return std::make_unique<ZstdOut>(filename, append, threads);
     return std::make_unique<NormOut>(filename, append);
 }
 
@@ -38,39 +49,177 @@ std::unique_ptr<IOOut> getIOOut(const std::string& filename,
 std::unique_ptr<IOIn> getIOIn(const std::string& filename) {
     if (!osutils::exists(filename)) return nullptr;
     if (isGZip(filename))
-        return std::make_unique<GZipIn>(filename);
+        return std::make_unique<GZipIn>(filename, READ_AHEAD_BLOCKS);
     else if (isLZ4(filename))
-        return std::make_unique<LZ4In>(filename.c_str());
+        return std::make_unique<LZ4In>(filename.c_str(), READ_AHEAD_BLOCKS);
+    else if (isZstd(filename))
+        return std::make_unique<ZstdIn>(filename, READ_AHEAD_BLOCKS);
+    else if (MmapIn::isMappable(filename))
+        return std::make_unique<MmapIn>(filename);
     return std::make_unique<NormIn>(filename);
 }
 
 bool TSVParser::next() {
     field_vec_.clear();
-    line_NO_++;
-    if (in_ptr_->readLine(buf_, 1024) == 0) return false;
-    if (buf_[0] == '#') return next();
-    strutils::split(buf_, split_ch_, field_vec_);
+    do {
+        line_NO_++;
+        if (!in_ptr_->readLine(line_)) return false;
+    } while (!line_.empty() && line_[0] == '#');
+    // fields do not include the line terminator
+    std::string_view fields = line_;
+    while (!fields.empty() && (fields.back() == '\n' || fields.back() == '\r'))
+        fields.remove_suffix(1);
+    strutils::split(fields, split_ch_, field_vec_);
     return true;
 }
 
+/**
+ * Parse a number with std::from_chars, mimicking std::stoi/std::stod.
+ */
+template <typename T>
+T parseNumber(std::string_view field) {
+    const char *first = field.data(), *last = first + field.size();
+    while (first < last && std::isspace((unsigned char)*first)) first++;
+    if (first < last && *first == '+') first++;
+    T val{};
+    auto res = std::from_chars(first, last, val);
+    if (res.ec == std::errc::result_out_of_range)
+        throw std::out_of_range("TSVParser: out of range '" +
+                                std::string(field) + "'");
+    if (res.ec != std::errc())
+        throw std::invalid_argument("TSVParser: cannot parse '" +
+                                    std::string(field) + "'");
+    return val;
+}
+
 template <>
 auto TSVParser::get<int>(const int& id) const -> int {
-    return std::stoi(field_vec_[id]);
+    return parseNumber<int>(field_vec_[id]);
+}
+
+template <>
+auto TSVParser::get<long>(const int& id) const -> long {
+    return parseNumber<long>(field_vec_[id]);
 }
 
 template <>
 auto TSVParser::get<float>(const int& id) const -> float {
-    return std::stof(field_vec_[id]);
+    return parseNumber<float>(field_vec_[id]);
 }
 
 template <>
 auto TSVParser::get<double>(const int& id) const -> double {
-    return std::stod(field_vec_[id]);
+    return parseNumber<double>(field_vec_[id]);
+}
+
+template <>
+auto TSVParser::get<std::string_view>(const int& id) const
+    -> std::string_view {
+    return field_vec_[id];
 }
 
 template <>
 auto TSVParser::get<std::string>(const int& id) const -> std::string {
-    return strutils::trim(field_vec_[id]);
+    const std::string_view& field = field_vec_[id];
+    size_t first = field.find_first_not_of(" \f\n\r\t\v");
+    if (first == std::string_view::npos) return std::string();
+    size_t last = field.find_last_not_of(" \f\n\r\t\v");
+    return std::string(field.substr(first, last - first + 1));
+}
+
+size_t parseIntBlock(std::string_view block, const std::vector<int>& cols,
+                     std::vector<std::vector<int>>& out, const char sep) {
+    out.resize(cols.size());
+    if (cols.empty()) return 0;
+    // column -> index in out, or -1 if the column is not required
+    int num_cols = *std::max_element(cols.begin(), cols.end()) + 1;
+    std::vector<int> slot(num_cols, -1);
+    for (size_t i = 0; i < cols.size(); i++) slot[cols[i]] = i;
+    std::vector<int> vals(cols.size());
+
+    thread_local std::vector<uint32_t> pos;
+    pos.clear();
+    strutils::indexChars(block.data(), block.size(), sep, '\n', pos);
+    // a virtual terminator for the last line
+    if (block.empty() || block.back() != '\n') pos.push_back(block.size());
+
+    size_t lines = 0, start = 0;
+    int field = 0, filled = 0;
+    bool skip = false;
+    for (uint32_t end : pos) {
+        if (field == 0 && start < block.size() && block[start] == '#')
+            skip = true;
+        if (!skip && field < num_cols && slot[field] >= 0) {
+            // an empty line has no field to parse
+            if (!(field == 0 && end == start &&
+                  (end == block.size() || block[end] == '\n'))) {
+                vals[slot[field]] =
+                    parseNumber<int>(block.substr(start, end - start));
+                filled++;
+            }
+        }
+        field++;
+        start = end + 1;
+        if (end == block.size() || block[end] == '\n') {  // end of line
+            if (!skip && filled == (int)cols.size()) {
+                for (size_t i = 0; i < cols.size(); i++)
+                    out[i].push_back(vals[i]);
+                lines++;
+            }
+            field = filled = 0;
+            skip = false;
+        }
+    }
+    return lines;
+}
+
+size_t parseIntColumns(const std::string& filename, const std::vector<int>& cols,
+                     std::vector<std::vector<int>>& out, const char sep) {
+    auto pin = getIOIn(filename);
+    if (pin == nullptr) {
+        std::cout << "File: " << filename << " does not exist!" << std::endl;
+        std::exit(-1);
+    }
+    const size_t BLOCK_SIZE = 1 << 20;
+    size_t lines = 0, len = 0;
+    // a mapped file is parsed in place, in windows of complete lines, since
+    // parseIntBlock() takes blocks less than 4GB
+    if (auto pmm = dynamic_cast<MmapIn*>(pin.get())) {
+        std::string_view data(pmm->data(), pmm->size());
+        for (size_t pos = 0; pos < data.size();) {
+            size_t end = pos + BLOCK_SIZE;
+            if (end >= data.size()) {
+                end = data.size();
+            } else {
+                size_t nl = data.rfind('\n', end - 1);
+                if (nl == std::string_view::npos || nl < pos)
+                    nl = data.find('\n', end);  // a very long line
+                end = nl == std::string_view::npos ? data.size() : nl + 1;
+            }
+            lines += parseIntBlock(data.substr(pos, end - pos), cols, out, sep);
+            pos = end;
+        }
+        return lines;
+    }
+    std::vector<char> buf(BLOCK_SIZE);
+    while (true) {
+        if (len == buf.size()) buf.resize(buf.size() * 2);  // a very long line
+        size_t num_read = pin->read(buf.data() + len, buf.size() - len);
+        len += num_read;
+        if (num_read == 0) {  // the last line has no '\n'
+            lines += parseIntBlock(std::string_view(buf.data(), len), cols,
+                                   out, sep);
+            break;
+        }
+        // parse complete lines and keep the partial last line
+        std::string_view data(buf.data(), len);
+        size_t last_nl = data.rfind('\n');
+        if (last_nl == std::string_view::npos) continue;
+        lines += parseIntBlock(data.substr(0, last_nl + 1), cols, out, sep);
+        len -= last_nl + 1;
+        std::memmove(buf.data(), buf.data() + last_nl + 1, len);
+    }
+    return lines;
 }
 
 }  // end namespace ioutils
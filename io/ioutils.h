@@ -3,13 +3,18 @@
 
 #include <tuple>
 #include <map>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <iostream>
 
 #include "iobase.h"
 #include "lz4io.h"
 #include "gzipio.h"
+#include "mmapio.h"
+#include "zstdio.h"
 #include "../os/osutils.h"
+#include "../str/strutils.h"
 
 namespace ioutils {
 
@@ -19,22 +24,37 @@ bool isGZip(const std::string& filename);
 // Return true if the given filename is lz4 format.
 bool isLZ4(const std::string& filename);
 
-// Get a writer pointer.
+// Return true if the given filename is zstd format.
+bool isZstd(const std::string& filename);
+
+// Get a writer pointer. Compressed formats that support it compress with
+// the given number of threads.
 std::unique_ptr<IOOut> getIOOut(const std::string& filename,
-                                const bool append = false);
+                                const bool append = false,
+                                const int threads = 1);
+
+// Number of blocks decoded ahead by readers of compressed files.
+static const int READ_AHEAD_BLOCKS = 4;
 
-// Get a reader pointer.
+// Get a reader pointer. Plain regular files are memory-mapped, and compressed
+// files are decoded READ_AHEAD_BLOCKS blocks ahead in a background thread.
 std::unique_ptr<IOIn> getIOIn(const std::string& filename);
 
+/**
+ * Parse a tab (or other char) separated file line by line. Lines starting with
+ * '#' are skipped. Fields are views into the line buffer, i.e., no memory is
+ * allocated per line, and numbers are parsed with std::from_chars. Fields (and
+ * getField() views) are valid until the next call of next().
+ */
 class TSVParser {
 private:
     char split_ch_;
     size_t line_NO_;
     std::string filename_;
 
-    // assume each line has a maximum length of 1024 bytes.
-    char buf_[1024];
-    std::vector<std::string> field_vec_;
+    // current line, a view into the buffer of the reader
+    std::string_view line_;
+    std::vector<std::string_view> field_vec_;
     std::unique_ptr<IOIn> in_ptr_;
 
 public:
@@ -58,12 +78,45 @@ public:
 
     size_t getLineNO() const { return line_NO_; }
 
-    const std::string getLine() const { return std::string(buf_); }
+    const std::string getLine() const { return std::string(line_); }
 
+    /**
+     * Return a view of the id-th field without copying.
+     */
+    std::string_view getField(const int id) const { return field_vec_[id]; }
+
+    /**
+     * Parse the id-th field as type T. Numbers are parsed by std::from_chars;
+     * as std::stoi etc., leading whitespace is skipped, and an
+     * std::invalid_argument or std::out_of_range is thrown on failure.
+     */
     template <typename T>
     auto get(const int& id) const -> T;
 };
 
+/**
+ * Fast path for loading integer columns. Parse the lines in 'block' and append
+ * the value of column cols[i] of each line to out[i]. Separators and newlines
+ * are located by strutils::indexChars() over the whole block and numbers are
+ * parsed by std::from_chars, without going through TSVParser. Lines starting
+ * with '#', empty lines and lines having less columns than required are
+ * skipped. The last line does not need to end with '\n'.
+ *
+ * Return the number of parsed lines; throw std::invalid_argument if a
+ * required field is not an integer.
+ */
+size_t parseIntBlock(std::string_view block, const std::vector<int>& cols,
+                     std::vector<std::vector<int>>& out,
+                     const char sep = '\t');
+
+/**
+ * Parse integer columns of a file, which is read block by block and each
+ * block is parsed by parseIntBlock().
+ */
+size_t parseIntColumns(const std::string& filename, const std::vector<int>& cols,
+                       std::vector<std::vector<int>>& out,
+                       const char sep = '\t');
+
 // vector
 template <typename TVal>
 void saveVec(const std::vector<TVal>& vec, const std::string& filename,
@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <thread>
+
+#include <unistd.h>
+
 #include "lz4io.h"
 
 namespace ioutils {
@@ -16,6 +21,33 @@ size_t readBin(FILE* fp, void* array, const size_t arrayBytes) {
     return std::fread(array, 1, arrayBytes, fp);
 }
 
+static const long FOOTER_BYTES = 2 * sizeof(long) + 2 * sizeof(int);
+
+/**
+ * Read the block index from the footer of fp. Return false if there is none.
+ * The file position is undefined afterwards.
+ */
+bool readIndex(FILE* fp, LZ4Index& index) {
+    index.clear();
+    long num_blocks, index_offset;
+    int version, magic;
+    if (std::fseek(fp, -FOOTER_BYTES, SEEK_END) != 0) return false;
+    if (std::fread(&num_blocks, sizeof(long), 1, fp) < 1 ||
+        std::fread(&index_offset, sizeof(long), 1, fp) < 1 ||
+        readInt(fp, &version) < 1 || readInt(fp, &magic) < 1)
+        return false;
+    if (magic != LZ4_INDEX_MAGIC || version != LZ4_INDEX_VERSION ||
+        num_blocks < 0 || std::fseek(fp, index_offset, SEEK_SET) != 0)
+        return false;
+    index.resize(num_blocks + 1);
+    if (std::fread(index.data(), sizeof(LZ4BlockPos), index.size(), fp) <
+        index.size()) {
+        index.clear();
+        return false;
+    }
+    return true;
+}
+
 //============================================================
 
 LZ4Out::LZ4Out() {
@@ -39,6 +71,11 @@ LZ4Out::~LZ4Out() {
 void LZ4Out::close() {
     if (output_ != nullptr) {
         writeChunk();
+        if (pool_)
+            pool_->flush([this](const std::string& chunk) {
+                writeCompressed(chunk.data(), chunk.size());
+            });
+        if (indexed_) writeIndex();
         fclose(output_);
         output_ = nullptr;
     }
@@ -46,6 +83,27 @@ void LZ4Out::close() {
 
 void LZ4Out::open(const char* file_name, const bool append) {
     close();
+    indexed_ = use_index_;
+    index_.clear();
+    num_written_ = 0;
+    file_pos_ = raw_pos_ = 0;
+    FILE* fp = append ? std::fopen(file_name, "r+b") : nullptr;
+    if (fp != nullptr) {
+        if (readIndex(fp, index_)) {
+            // continue the index, and overwrite it by the new blocks
+            file_pos_ = index_.back().offset;
+            raw_pos_ = index_.back().pos;
+            index_.pop_back();
+            num_written_ = index_.size();
+            if (ftruncate(fileno(fp), file_pos_) != 0) indexed_ = false;
+        } else {
+            // positions of the existing blocks are unknown
+            std::fseek(fp, 0, SEEK_END);
+            if (std::ftell(fp) > 0) indexed_ = false;
+        }
+        std::fclose(fp);
+    }
+    if (!indexed_) index_.clear();
     const char* mode = append ? "ab" : "wb";
     output_ = std::fopen(file_name, mode);
     if (output_ == nullptr) {
@@ -54,6 +112,16 @@ void LZ4Out::open(const char* file_name, const bool append) {
     }
 }
 
+void LZ4Out::setThreads(const int threads) {
+    if (pool_ && output_ != nullptr) {
+        writeChunk();
+        pool_->flush([this](const std::string& chunk) {
+            writeCompressed(chunk.data(), chunk.size());
+        });
+    }
+    pool_.reset(threads > 1 ? new BlockPool(threads) : nullptr);
+}
+
 void LZ4Out::write(const void* dat, const size_t len) {
     size_t written = 0;
     while (len - written > 0) {
@@ -66,17 +134,55 @@ void LZ4Out::write(const void* dat, const size_t len) {
     }
 }
 
+static std::string compressBlock(const std::string& data) {
+    std::string chunk(CHUNK_CAPACITY, '\0');
+    int chunk_len = LZ4_compress_fast(data.data(), &chunk[0], data.size(),
+                                      CHUNK_CAPACITY, 9);
+    chunk.resize(chunk_len > 0 ? chunk_len : 0);
+    return chunk;
+}
+
+void LZ4Out::writeCompressed(const char* chunk, const size_t len) {
+    if (len == 0) return;
+    writeInt(output_, len);
+    writeBin(output_, chunk, len);
+    if (indexed_) index_[num_written_++].offset = file_pos_;
+    file_pos_ += sizeof(int) + len;
+}
+
 void LZ4Out::writeChunk() {
     if (len_dat_ == 0) return;
+    // the file offset is filled in when the block is written
+    if (indexed_) index_.push_back({-1, raw_pos_});
+    raw_pos_ += len_dat_;
+    if (pool_) {
+        pool_->submit(
+            [data = std::string(data_buf_, len_dat_)]() {
+                return compressBlock(data);
+            },
+            [this](const std::string& chunk) {
+                writeCompressed(chunk.data(), chunk.size());
+            });
+        len_dat_ = 0;
+        return;
+    }
     size_t chunk_len =
         LZ4_compress_fast(data_buf_, chunk_buf_, len_dat_, CHUNK_CAPACITY, 9);
-    if (chunk_len > 0) {
-        writeInt(output_, chunk_len);
-        writeBin(output_, chunk_buf_, chunk_len);
-    }
+    writeCompressed(chunk_buf_, chunk_len);
     len_dat_ = 0;
 }
 
+void LZ4Out::writeIndex() {
+    index_.push_back({file_pos_, raw_pos_});
+    writeInt(output_, 0);
+    long num_blocks = index_.size() - 1, index_offset = file_pos_ + sizeof(int);
+    writeBin(output_, index_.data(), index_.size() * sizeof(LZ4BlockPos));
+    writeBin(output_, &num_blocks, sizeof(long));
+    writeBin(output_, &index_offset, sizeof(long));
+    writeInt(output_, LZ4_INDEX_VERSION);
+    writeInt(output_, LZ4_INDEX_MAGIC);
+}
+
 void LZ4Out::compress(const char* file_name) {
     FILE* file_id = std::fopen(file_name, "rb");
     if (file_id == nullptr) {
@@ -99,29 +205,28 @@ void LZ4Out::compress(const char* file_name) {
 // const std::unordered_set<std::string> LZ4In::lz4_ext_set{
 //     {".lz", ".lz4"}};
 
-LZ4In::LZ4In() {
+LZ4In::LZ4In() : BlockIn(DATA_CAPACITY) {
     chunk_buf_ = new char[CHUNK_CAPACITY];
-    data_buf_ = new char[DATA_CAPACITY];
-    if (data_buf_ == nullptr || chunk_buf_ == nullptr) {
+    if (chunk_buf_ == nullptr) {
         std::fprintf(stderr, "Allocate space failed!\n");
         exit(1);
     }
     input_ = nullptr;
-    len_dat_ = num_read_ = 0;
 }
 
 LZ4In::~LZ4In() {
     close();
     if (chunk_buf_ != nullptr) delete[] chunk_buf_;
-    if (data_buf_ != nullptr) delete[] data_buf_;
 }
 
 void LZ4In::close() {
+    resetBlock();
     if (input_ != nullptr) {
         fclose(input_);
         input_ = nullptr;
     }
-    len_dat_ = num_read_ = 0;
+    index_.clear();
+    end_ = -1;
 }
 
 void LZ4In::open(const char* file_name) {
@@ -131,68 +236,83 @@ void LZ4In::open(const char* file_name) {
         std::fprintf(stderr, "Open file '%s' failed!\n", file_name);
         exit(1);
     }
+    readIndex(input_, index_);
+    std::fseek(input_, 0, SEEK_SET);
 }
 
-bool LZ4In::readOriChunk(char* dat, size_t& len) {
-    len = 0;
-    int chunk_len;
-    size_t num_read = readInt(input_, &chunk_len);
-    if (num_read < 1 || chunk_len == 0) return false;
-    len = readBin(input_, dat, chunk_len);
-    return len > 0;
+bool LZ4In::readLine(std::string_view& line) {
+    if (end_ >= 0 && (long)tell() >= end_) return false;
+    return BlockIn::readLine(line);
 }
 
-bool LZ4In::readChunk(char* dat, size_t& len) {
-    len = 0;
-    int chunk_len;
-    size_t num_read = readInt(input_, &chunk_len);
-    if (num_read < 1 || chunk_len == 0) return false;
-    readBin(input_, chunk_buf_, chunk_len);
-    len = LZ4_decompress_safe(chunk_buf_, dat, chunk_len, (int)DATA_CAPACITY);
-    return len > 0;
+bool LZ4In::seek(const size_t pos) {
+    if (!isIndexed() || (long)pos > getSize()) return false;
+    // the last block starting at or before pos
+    size_t k = 0;
+    if (getBlocks() > 0)
+        k = std::upper_bound(index_.begin(), index_.end() - 1, (long)pos,
+                             [](const long p, const LZ4BlockPos& blk) {
+                                 return p < blk.pos;
+                             }) -
+            index_.begin() - 1;
+    resetBlock(index_[k].pos);
+    std::fseek(input_, index_[k].offset, SEEK_SET);
+    skip(pos - index_[k].pos);
+    return true;
 }
 
-bool LZ4In::eof() {
-    if (num_read_ < len_dat_) return false;
-    return !fill();
+bool LZ4In::seekPart(const int part, const int num_parts) {
+    if (!isIndexed() || part < 0 || part >= num_parts) return false;
+    size_t n = getBlocks();
+    long begin = index_[n * part / num_parts].pos;
+    end_ = index_[n * (part + 1) / num_parts].pos;
+    if (begin == 0) return seek(0);
+    // skip the line started in the previous part; a line starting exactly at
+    // 'begin' follows a newline at begin - 1
+    seek(begin - 1);
+    std::string_view line;
+    BlockIn::readLine(line);
+    return true;
 }
 
-bool LZ4In::fill() {
-    num_read_ = 0;
-    return readChunk(data_buf_, len_dat_);
+size_t LZ4In::readBlocks(const size_t first, const size_t last, char* dst,
+                         int threads) const {
+    if (!isIndexed() || first >= last || last > getBlocks()) return 0;
+    threads = std::max(1, std::min(threads, (int)(last - first)));
+    int fd = fileno(input_);
+    auto work = [&](const size_t begin, const size_t end) {
+        std::unique_ptr<char[]> chunk(new char[CHUNK_CAPACITY]);
+        for (size_t k = begin; k < end; k++) {
+            long len = index_[k + 1].offset - index_[k].offset - sizeof(int),
+                 size = index_[k + 1].pos - index_[k].pos;
+            if (pread(fd, chunk.get(), len, index_[k].offset + sizeof(int)) !=
+                    len ||
+                LZ4_decompress_safe(chunk.get(),
+                                    dst + index_[k].pos - index_[first].pos,
+                                    len, size) != size) {
+                std::fprintf(stderr, "Decompress block %lu failed!\n", k);
+                exit(1);
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    size_t n = last - first;
+    for (int i = 1; i < threads; i++)
+        workers.emplace_back(work, first + n * i / threads,
+                             first + n * (i + 1) / threads);
+    work(first, first + n / threads);
+    for (auto& worker : workers) worker.join();
+    return index_[last].pos - index_[first].pos;
 }
 
-size_t LZ4In::read(const void* dat, const size_t len) {
-    if (len <= 0 || dat == nullptr) return 0;
-    size_t num_read = 0, num_to_read = 0;
-    while (!eof() && num_read < len) {
-        // min(num_requirement, num_available)
-        num_to_read = std::min(len - num_read, len_dat_ - num_read_);
-        std::memcpy((char*)dat + num_read, data_buf_ + num_read_, num_to_read);
-        num_read_ += num_to_read;
-        num_read += num_to_read;
-    }
-    return num_read;
-}
-
-size_t LZ4In::readLine(const void* dat, const size_t len) {
-    if (len <= 0 || dat == nullptr) return 0;
-    size_t num_read = 0, num_to_read = 0;
-    while (!eof() && num_read < len - 1) {
-        // min(num_requirement, num_available)
-        num_to_read = std::min(len - num_read, len_dat_ - num_read_);
-        char* src_ptr = data_buf_ + num_read_;
-        char* dst_ptr = (char*)dat + num_read;
-        for (size_t i = 0; i < num_to_read; i++) {
-            *dst_ptr++ = *src_ptr++;
-            num_read++;
-            num_read_++;
-            if (*(dst_ptr - 1) == '\n') break;
-        }
-        if (*(dst_ptr - 1) == '\n') break;
-    }
-    *((char*)dat + num_read) = '\0';
-    return num_read;
+size_t LZ4In::readBlock(char* dat, const size_t capacity) {
+    int chunk_len;
+    if (input_ == nullptr) return 0;
+    size_t num_read = readInt(input_, &chunk_len);
+    if (num_read < 1 || chunk_len <= 0) return 0;
+    readBin(input_, chunk_buf_, chunk_len);
+    int len = LZ4_decompress_safe(chunk_buf_, dat, chunk_len, (int)capacity);
+    return len > 0 ? len : 0;
 }
 
 void LZ4In::decompress(const char* output_file_name) {
@@ -4,8 +4,11 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <vector>
 
-#include "iobase.h"
+#include "blockio.h"
+#include "blockpool.h"
 #include "../lz4/lib/lz4.h"
 
 namespace ioutils {
@@ -17,13 +20,53 @@ enum {
 static const size_t DATA_CAPACITY = BLOCK_BYTES;
 static const size_t CHUNK_CAPACITY = LZ4_COMPRESSBOUND(BLOCK_BYTES);
 
+static const int LZ4_INDEX_VERSION = 1;
+static const int LZ4_INDEX_MAGIC = 0x49345A4C;  // "LZ4I" on disk
+
+/**
+ * Position of a block in an LZ4 file: 'offset' is the file offset of its
+ * compressed-size field, and 'pos' is the position of its first byte in the
+ * decompressed stream.
+ */
+struct LZ4BlockPos {
+    long offset, pos;
+};
+
+/**
+ * Block index of an LZ4 file. The last entry marks the end of the blocks, i.e.,
+ * the end of the file data and the decompressed size.
+ */
+typedef std::vector<LZ4BlockPos> LZ4Index;
+
+/**
+ * LZ4 writer. By default, a block index is appended to the blocks, so that
+ * the file can be read from any position, and in parallel. The index follows
+ * a zero compressed-size, where readers without index support stop:
+ *
+ * +--------+-----+---+---------------------+--------+------------+-----+-----+
+ * | blocks | ... | 0 | LZ4BlockPos x (n+1) | long n | long index | int | int |
+ * |        |     |   |                     |        | offset     | ver | mag |
+ * +--------+-----+---+---------------------+--------+------------+-----+-----+
+ */
 class LZ4Out : public IOOut {
 private:
     char *data_buf_ = nullptr, *chunk_buf_ = nullptr;
     size_t len_dat_;
     FILE* output_ = nullptr;
 
+    // compresses blocks in parallel if more than one thread is used
+    std::unique_ptr<BlockPool> pool_;
+
+    // block index
+    bool use_index_ = true, indexed_ = false;
+    LZ4Index index_;
+    size_t num_written_ = 0;  // blocks written
+    long file_pos_ = 0, raw_pos_ = 0;
+
 private:
+    void writeCompressed(const char* chunk, const size_t len);
+    void writeIndex();
+
     /**
      * Compress the data in internal data buffer, and compressed data is
      * buffered in the internal chunk buffer. A compressed block has the
@@ -33,12 +76,18 @@ private:
      * | compressed-size | data | compressed-size | data | ...
      * +-----------------+------+-----------------+------+----
      *
+     *
+     * In parallel mode, the block is handed to the pool, and compressed
+     * blocks are written when they are due, in the same order and format.
      */
     void writeChunk();
 
 public:
     LZ4Out();
-    LZ4Out(const char* file_name, const bool append = false) : LZ4Out() {
+    LZ4Out(const char* file_name, const bool append = false,
+           const int threads = 1)
+        : LZ4Out() {
+        setThreads(threads);
         open(file_name, append);
     }
     virtual ~LZ4Out();
@@ -54,7 +103,14 @@ public:
         : data_buf_(std::move(other.data_buf_)),
           chunk_buf_(std::move(other.chunk_buf_)),
           len_dat_(std::move(other.len_dat_)),
-          output_(std::move(other.output_)) {
+          output_(std::move(other.output_)),
+          pool_(std::move(other.pool_)),
+          use_index_(other.use_index_),
+          indexed_(other.indexed_),
+          index_(std::move(other.index_)),
+          num_written_(other.num_written_),
+          file_pos_(other.file_pos_),
+          raw_pos_(other.raw_pos_) {
         other.data_buf_ = other.chunk_buf_ = nullptr;
         other.output_ = nullptr;
         other.len_dat_ = 0;
@@ -66,14 +122,37 @@ public:
         chunk_buf_ = std::move(other.chunk_buf_);
         len_dat_ = std::move(other.len_dat_);
         output_ = std::move(other.output_);
+        pool_ = std::move(other.pool_);
+        use_index_ = other.use_index_;
+        indexed_ = other.indexed_;
+        index_ = std::move(other.index_);
+        num_written_ = other.num_written_;
+        file_pos_ = other.file_pos_;
+        raw_pos_ = other.raw_pos_;
         other.len_dat_ = 0;
         other.data_buf_ = other.chunk_buf_ = nullptr;
         other.output_ = nullptr;
         return *this;
     }
 
+    /**
+     * Open a file for writing. When appending to an indexed file, its index
+     * is extended; when appending to a file without index, no index is
+     * written.
+     */
     void open(const char* file_name, const bool append = false);
 
+    /**
+     * Whether to write a block index for files opened from now on.
+     */
+    void setIndexed(const bool indexed) { use_index_ = indexed; }
+
+    /**
+     * Compress blocks with the given number of threads. The output is
+     * identical to that of a single thread.
+     */
+    void setThreads(const int threads);
+
     /**
      * Add 'data' of 'length' to internal data buffer. The data length may be
      * larger than the internal buffer size. If the internal data buffer is
@@ -88,25 +167,26 @@ public:
     void compress(const char* input_file_name);
 };
 
-class LZ4In : public IOIn {
+/**
+ * LZ4 reader. Files with a block index can also be read from any position,
+ * split into parts for parallel readers, and decompressed in parallel.
+ */
+class LZ4In : public BlockIn {
 private:
-    char *chunk_buf_ = nullptr, *data_buf_ = nullptr;
-    size_t len_dat_, num_read_;
+    char* chunk_buf_ = nullptr;
     FILE* input_ = nullptr;
 
-private:
-    bool fill();
-    bool readOriChunk(char* data, size_t& length);
-    bool readChunk(char* data, size_t& length);
+    LZ4Index index_;
+    long end_ = -1;  // readLine() stops at lines starting from end_
+
+protected:
+    size_t readBlock(char* data, const size_t capacity) override;
 
 public:
     LZ4In();
-    LZ4In(const char* file_name) : LZ4In() {
-        input_ = fopen(file_name, "rb");
-        if (input_ == nullptr) {
-            fprintf(stderr, "Open file '%s' failed!\n", file_name);
-            exit(1);
-        }
+    LZ4In(const char* file_name, const int read_ahead = 0) : LZ4In() {
+        open(file_name);
+        setReadAhead(read_ahead);
     }
     virtual ~LZ4In();
 
@@ -118,50 +198,69 @@ public:
 
     // move constructor
     LZ4In(LZ4In&& other)
-        : chunk_buf_(std::move(other.chunk_buf_)),
-          data_buf_(std::move(other.data_buf_)),
-          len_dat_(std::move(other.len_dat_)),
-          num_read_(std::move(other.num_read_)),
-          input_(std::move(other.input_)) {
-        other.chunk_buf_ = other.data_buf_ = nullptr;
+        : BlockIn(std::move(other)),
+          chunk_buf_(std::move(other.chunk_buf_)),
+          input_(std::move(other.input_)),
+          index_(std::move(other.index_)),
+          end_(other.end_) {
+        other.chunk_buf_ = nullptr;
         other.input_ = nullptr;
-        other.len_dat_ = other.num_read_ = 0;
     }
 
     // move assignment
     LZ4In& operator=(LZ4In&& other) {
+        BlockIn::operator=(std::move(other));
         chunk_buf_ = std::move(other.chunk_buf_);
-        data_buf_ = std::move(other.data_buf_);
-        len_dat_ = std::move(other.len_dat_);
-        num_read_ = std::move(other.num_read_);
         input_ = std::move(other.input_);
-        other.chunk_buf_ = other.data_buf_ = nullptr;
+        index_ = std::move(other.index_);
+        end_ = other.end_;
+        other.chunk_buf_ = nullptr;
         other.input_ = nullptr;
-        other.len_dat_ = other.num_read_ = 0;
         return *this;
     }
 
     void open(const char* file_name);
     void close() override;
-    bool eof() override;
+
+    using BlockIn::readLine;
+    bool readLine(std::string_view& line) override;
+
+    bool isIndexed() const { return !index_.empty(); }
+
+    // number of blocks of an indexed file
+    size_t getBlocks() const { return isIndexed() ? index_.size() - 1 : 0; }
+
+    // decompressed size of an indexed file, or -1 if it is unknown
+    long getSize() const { return isIndexed() ? index_.back().pos : -1; }
+
+    // position of block k in the decompressed stream
+    long getBlockPos(const size_t k) const { return index_[k].pos; }
 
     /**
-     * Read characters of length at most len bytes. The returned string placed
-     * in 'data' is *not* null-terminated, and is of length at most 'len'. The
-     * function return value is the actual number of bytes placed in buffer.
+     * Move to position pos of the decompressed stream. Return false if the
+     * file has no index or pos is beyond the end.
      */
-    size_t read(const void* data, const size_t len) override;
+    bool seek(const size_t pos);
 
     /**
-     * Read characters until a newline ('\n') is encountered. If a newline
-     * character is not encountered in the first (len - 1) bytes, then the
-     * excess characters are discarded. The returned string placed in 'data' is
-     * null-terminated and includes the newline character if it was read in the
-     * first (n - 1) bytes. The function return value is the number of bytes
-     * placed in buffer (which includes the newline character if encountered,
-     * but excludes the terminating null byte).
-     **/
-    size_t readLine(const void* data, const size_t len) override;
+     * Restrict the reader to the part-th of num_parts parts of the file, so
+     * that num_parts readers can load a file in parallel. Parts are ranges of
+     * blocks, and readLine() returns the lines that start in the part, i.e.,
+     * a line crossing two parts belongs to the part where it starts. Return
+     * false if the file has no index or part is not in [0, num_parts).
+     */
+    bool seekPart(const int part, const int num_parts);
+
+    /**
+     * Decompress blocks [first, last) into dst with the given number of
+     * threads, each taking a disjoint range of blocks. dst must have space for
+     * getBlockPos(last) - getBlockPos(first) bytes. The reading position is
+     * not changed. Return the number of bytes decompressed, or 0 if the file
+     * has no index or the range is empty or beyond getBlocks(). At least one
+     * and at most last - first threads are used.
+     */
+    size_t readBlocks(const size_t first, const size_t last, char* dst,
+                      const int threads = 1) const;
 
     void decompress(const char* output_file_name);
 };
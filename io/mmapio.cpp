@@ -0,0 +1,92 @@
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mmapio.h"
+
+namespace ioutils {
+
+bool MmapIn::isMappable(const std::string& filename) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) return false;
+    return S_ISREG(st.st_mode);
+}
+
+MmapIn::MmapIn(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::fprintf(stderr, "Open file '%s' failed!\n", filename.c_str());
+        exit(1);
+    }
+    size_ = st.st_size;
+    // an empty file cannot be mapped, and reads as eof right away
+    if (size_ > 0) {
+        void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            std::fprintf(stderr, "Map file '%s' failed!\n", filename.c_str());
+            exit(1);
+        }
+        // hints only, failures are harmless
+        madvise(addr, size_, MADV_SEQUENTIAL);
+        madvise(addr, size_, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+        if (size_ >= (2 << 20)) madvise(addr, size_, MADV_HUGEPAGE);
+#endif
+        data_ = (const char*)addr;
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+void MmapIn::close() {
+    if (data_ != nullptr) {
+        munmap((void*)data_, size_);
+        data_ = nullptr;
+    }
+    size_ = pos_ = 0;
+}
+
+size_t MmapIn::read(const void* data, const size_t len) {
+    if (len <= 0 || data == nullptr) return 0;
+    size_t num_read = std::min(len, size_ - pos_);
+    std::memcpy(const_cast<void*>(data), data_ + pos_, num_read);
+    pos_ += num_read;
+    return num_read;
+}
+
+size_t MmapIn::readLine(const void* data, const size_t len) {
+    if (len <= 0 || data == nullptr) return 0;
+    char* dst = (char*)data;
+    size_t num_read = std::min(len - 1, size_ - pos_);
+    const char* src = data_ + pos_;
+    const char* nl = (const char*)std::memchr(src, '\n', num_read);
+    if (nl != nullptr) num_read = nl - src + 1;
+    std::memcpy(dst, src, num_read);
+    dst[num_read] = '\0';
+    pos_ += num_read;
+    return num_read;
+}
+
+bool MmapIn::readLine(std::string_view& line) {
+    if (eof()) return false;
+    const char* src = data_ + pos_;
+    size_t len = size_ - pos_;
+    const char* nl = (const char*)std::memchr(src, '\n', len);
+    if (nl != nullptr) len = nl - src + 1;
+    line = std::string_view(src, len);
+    pos_ += len;
+    return true;
+}
+
+std::string_view MmapIn::readSpan(const size_t len) {
+    size_t num_read = std::min(len, size_ - pos_);
+    std::string_view span(data_ + pos_, num_read);
+    pos_ += num_read;
+    return span;
+}
+
+}  // namespace ioutils
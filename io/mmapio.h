@@ -0,0 +1,90 @@
+/**
+ * Copyright (C) by J.Z. (10/19/2026 15:40)
+ * Distributed under terms of the MIT license.
+ */
+
+#ifndef __MMAPIO_H__
+#define __MMAPIO_H__
+
+#include <string>
+#include <string_view>
+
+#include "iobase.h"
+
+namespace ioutils {
+
+/**
+ * Read a regular file through a read-only memory mapping. Besides the IOIn
+ * interface, the whole file is available as a span, i.e., data() and size(),
+ * and readSpan()/readLine() return views into the mapping without copying.
+ *
+ * The kernel is advised that the mapping is read sequentially and will be
+ * needed soon, and files of at least 2MB are also advised to use transparent
+ * huge pages where the kernel supports it for file mappings.
+ */
+class MmapIn : public IOIn {
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0, pos_ = 0;
+
+public:
+    MmapIn(const std::string& filename);
+    virtual ~MmapIn() { close(); }
+
+    // disable copy constructor
+    MmapIn(const MmapIn&) = delete;
+
+    // disable copy assignment
+    MmapIn& operator=(const MmapIn&) = delete;
+
+    // move constructor
+    MmapIn(MmapIn&& other)
+        : data_(other.data_), size_(other.size_), pos_(other.pos_) {
+        other.data_ = nullptr;
+        other.size_ = other.pos_ = 0;
+    }
+
+    // move assignment
+    MmapIn& operator=(MmapIn&& other) {
+        close();
+        data_ = other.data_;
+        size_ = other.size_;
+        pos_ = other.pos_;
+        other.data_ = nullptr;
+        other.size_ = other.pos_ = 0;
+        return *this;
+    }
+
+    /**
+     * Return true if filename can be mapped, i.e., is a regular file. Pipes
+     * and devices should be read by NormIn.
+     */
+    static bool isMappable(const std::string& filename);
+
+    void close() override;
+
+    bool eof() override { return pos_ >= size_; }
+
+    size_t read(const void* data, const size_t len) override;
+
+    size_t readLine(const void* data, const size_t len) override;
+
+    bool readLine(std::string_view& line) override;
+
+    // the whole file
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // current reading position
+    size_t tell() const { return pos_; }
+    void seek(const size_t pos) { pos_ = pos < size_ ? pos : size_; }
+
+    /**
+     * Return a view of the next (at most) len bytes and move forward.
+     */
+    std::string_view readSpan(const size_t len);
+};
+
+}  // namespace ioutils
+
+#endif /* __MMAPIO_H__ */
@@ -0,0 +1,103 @@
+/**
+ * Copyright (C) by J.Z. (10/19/2026 18:05)
+ * Distributed under terms of the MIT license.
+ */
+
+#ifndef __VARINT_H__
+#define __VARINT_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ioutils {
+
+/**
+ * Map a signed int to an unsigned one with small absolute values mapped to
+ * small numbers: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+ */
+inline uint32_t zigzag(const int v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+inline int unzigzag(const uint32_t v) { return (int)(v >> 1) ^ -(int)(v & 1); }
+
+/**
+ * Append v as a varint, i.e., 7 bits per byte with the high bit set on all but
+ * the last byte.
+ */
+inline void putVarint(uint32_t v, std::string& out) {
+    while (v >= 0x80) {
+        out.push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((char)v);
+}
+
+/**
+ * Decode a varint at p into v, and return the position after it. The buffer
+ * must be trusted, e.g., built in memory by putVarint().
+ */
+inline const char* getVarint(const char* p, uint32_t& v) {
+    uint32_t b = (uint8_t)*p++;
+    v = b & 0x7F;
+    for (int shift = 7; b >= 0x80; shift += 7) {
+        b = (uint8_t)*p++;
+        v |= (b & 0x7F) << shift;
+    }
+    return p;
+}
+
+/**
+ * Decode a varint at p into v without reading at or beyond end. Return the
+ * position after it, or nullptr if it is truncated or longer than 5 bytes.
+ */
+inline const char* getVarint(const char* p, const char* end, uint32_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 35; shift += 7) {
+        uint32_t b = (uint8_t)*p++;
+        v |= (b & 0x7F) << shift;
+        if (b < 0x80) return p;
+    }
+    return nullptr;
+}
+
+/**
+ * Append a list of ints as its length followed by the zigzag coded gaps
+ * between consecutive values, where the first gap is taken from base. Sorted
+ * lists with nearby values, e.g., neighbors of a node after defrag(), take
+ * one or two bytes per value.
+ */
+inline void putDeltas(const std::vector<int>& vals, const int base,
+                      std::string& out) {
+    putVarint(vals.size(), out);
+    uint32_t prev = base;
+    for (int v : vals) {
+        // gaps wrap around in 32 bits, which decoding undoes
+        putVarint(zigzag((int)((uint32_t)v - prev)), out);
+        prev = v;
+    }
+}
+
+/**
+ * Decode a list written by putDeltas() in [p, end), appending the values to
+ * vals. Return the position after the list, or nullptr if it is corrupted.
+ */
+inline const char* getDeltas(const char* p, const char* end, const int base,
+                             std::vector<int>& vals) {
+    uint32_t n, gap, prev = base;
+    if ((p = getVarint(p, end, n)) == nullptr) return nullptr;
+    // each value takes at least one byte
+    if (n > (size_t)(end - p)) return nullptr;
+    vals.reserve(vals.size() + n);
+    for (uint32_t i = 0; i < n; i++) {
+        if ((p = getVarint(p, end, gap)) == nullptr) return nullptr;
+        prev += (uint32_t)unzigzag(gap);
+        vals.push_back((int)prev);
+    }
+    return p;
+}
+
+}  // namespace ioutils
+
+#endif /* __VARINT_H__ */
@@ -0,0 +1,116 @@
+#include "zstdio.h"
+
+namespace ioutils {
+
+static void checkZstd(const size_t code, const char* what) {
+    if (ZSTD_isError(code)) {
+        std::fprintf(stderr, "%s failed: %s\n", what, ZSTD_getErrorName(code));
+        exit(1);
+    }
+}
+
+ZstdOut::ZstdOut(const std::string& filename, const bool append,
+                 const int threads, const int level) {
+    output_ = std::fopen(filename.c_str(), append ? "ab" : "wb");
+    if (output_ == nullptr) {
+        std::fprintf(stderr, "Open file '%s' failed!\n", filename.c_str());
+        exit(1);
+    }
+    cctx_ = ZSTD_createCCtx();
+    checkZstd(ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level),
+              "Set compression level");
+    // fails if zstd is built without multi-threading, then use one thread
+    if (threads > 1)
+        ZSTD_CCtx_setParameter(cctx_, ZSTD_c_nbWorkers, threads);
+    in_cap_ = ZSTD_CStreamInSize();
+    out_cap_ = ZSTD_CStreamOutSize();
+    in_buf_.reset(new char[in_cap_]);
+    out_buf_.reset(new char[out_cap_]);
+}
+
+ZstdOut::~ZstdOut() { close(); }
+
+void ZstdOut::compress(const ZSTD_EndDirective mode) {
+    ZSTD_inBuffer input = {in_buf_.get(), len_dat_, 0};
+    size_t remaining;
+    do {
+        ZSTD_outBuffer output = {out_buf_.get(), out_cap_, 0};
+        remaining = ZSTD_compressStream2(cctx_, &output, &input, mode);
+        checkZstd(remaining, "Compress");
+        std::fwrite(out_buf_.get(), 1, output.pos, output_);
+        // when ending, loop until the frame is flushed; otherwise until the
+        // input is consumed
+    } while (mode == ZSTD_e_end ? remaining != 0 : input.pos < input.size);
+    len_dat_ = 0;
+}
+
+void ZstdOut::write(const void* dat, const size_t len) {
+    size_t written = 0;
+    while (len - written > 0) {
+        size_t num_available = in_cap_ - len_dat_;
+        if (num_available == 0) compress(ZSTD_e_continue);
+        size_t num_to_write = std::min(len - written, in_cap_ - len_dat_);
+        std::memcpy(in_buf_.get() + len_dat_, (char*)dat + written,
+                    num_to_write);
+        len_dat_ += num_to_write;
+        written += num_to_write;
+    }
+}
+
+void ZstdOut::close() {
+    if (output_ != nullptr) {
+        compress(ZSTD_e_end);
+        ZSTD_freeCCtx(cctx_);
+        cctx_ = nullptr;
+        std::fclose(output_);
+        output_ = nullptr;
+    }
+}
+
+//============================================================
+
+const size_t ZstdIn::MAX_BUF_SIZE = 128 * 1024;
+
+ZstdIn::ZstdIn(const std::string& filename, const int read_ahead)
+    : BlockIn(MAX_BUF_SIZE) {
+    input_ = std::fopen(filename.c_str(), "rb");
+    if (input_ == nullptr) {
+        std::fprintf(stderr, "Open file '%s' failed!\n", filename.c_str());
+        exit(1);
+    }
+    dctx_ = ZSTD_createDCtx();
+    in_cap_ = ZSTD_DStreamInSize();
+    in_buf_.reset(new char[in_cap_]);
+    in_ = {in_buf_.get(), 0, 0};
+    setReadAhead(read_ahead);
+}
+
+ZstdIn::~ZstdIn() { close(); }
+
+void ZstdIn::close() {
+    resetBlock();
+    if (input_ != nullptr) {
+        ZSTD_freeDCtx(dctx_);
+        dctx_ = nullptr;
+        std::fclose(input_);
+        input_ = nullptr;
+    }
+}
+
+size_t ZstdIn::readBlock(char* dat, const size_t capacity) {
+    if (input_ == nullptr) return 0;
+    ZSTD_outBuffer output = {dat, capacity, 0};
+    while (output.pos < output.size) {
+        if (in_.pos == in_.size) {
+            in_.size = std::fread(in_buf_.get(), 1, in_cap_, input_);
+            in_.pos = 0;
+        }
+        size_t last_pos = output.pos;
+        checkZstd(ZSTD_decompressStream(dctx_, &output, &in_), "Decompress");
+        // no more input, and nothing buffered in the decoder
+        if (in_.size == 0 && output.pos == last_pos) break;
+    }
+    return output.pos;
+}
+
+}  // namespace ioutils
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) by J.Z. (10/19/2026 17:10)
+ * Distributed under terms of the MIT license.
+ */
+
+#ifndef __ZSTDIO_H__
+#define __ZSTDIO_H__
+
+#include <cstdio>
+#include <cstring>
+
+#include <memory>
+#include <string>
+
+#include "blockio.h"
+#include "../zstd/lib/zstd.h"
+
+namespace ioutils {
+
+/**
+ * Zstandard writer. Levels range from 1 (fastest) to ZSTD_maxCLevel() (19,
+ * best); negative levels trade ratio for more speed. With more than one
+ * thread, zstd compresses jobs of the stream in parallel and the output is
+ * still a single frame.
+ */
+class ZstdOut : public IOOut {
+private:
+    FILE* output_ = nullptr;
+    ZSTD_CCtx* cctx_ = nullptr;
+    std::unique_ptr<char[]> in_buf_, out_buf_;
+    size_t in_cap_, out_cap_, len_dat_ = 0;
+
+private:
+    /**
+     * Compress the buffered data. When ending, the frame is completed.
+     */
+    void compress(const ZSTD_EndDirective mode);
+
+public:
+    ZstdOut(const std::string& filename, const bool append = false,
+            const int threads = 1, const int level = ZSTD_CLEVEL_DEFAULT);
+    virtual ~ZstdOut();
+
+    // disable copy constructor
+    ZstdOut(const ZstdOut&) = delete;
+
+    // disable copy assignment
+    ZstdOut& operator=(const ZstdOut&) = delete;
+
+    void write(const void* data, const size_t length) override;
+
+    void close() override;
+};
+
+/**
+ * Zstandard reader. Concatenated frames are read as one stream.
+ */
+class ZstdIn : public BlockIn {
+private:
+    static const size_t MAX_BUF_SIZE;
+
+    FILE* input_ = nullptr;
+    ZSTD_DCtx* dctx_ = nullptr;
+    std::unique_ptr<char[]> in_buf_;
+    size_t in_cap_;
+    ZSTD_inBuffer in_;
+
+protected:
+    size_t readBlock(char* dat, const size_t capacity) override;
+
+public:
+    ZstdIn(const std::string& filename, const int read_ahead = 0);
+    virtual ~ZstdIn();
+
+    // disable copy constructor
+    ZstdIn(const ZstdIn&) = delete;
+
+    // disable copy assignment
+    ZstdIn& operator=(const ZstdIn&) = delete;
+
+    void close() override;
+};
+
+}  // namespace ioutils
+
+#endif /* __ZSTDIO_H__ */
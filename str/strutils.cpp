@@ -1,5 +1,12 @@
+#include <algorithm>
+
 #include "strutils.h"
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define STRUTILS_X86_DISPATCH 1
+#endif
+
 namespace strutils {
 
 void splitFilename(const std::string &filename, std::string &base,
@@ -92,6 +99,104 @@ std::vector<std::string> split(const std::string &s, const char delim) {
     return elems;
 }
 
+void split(std::string_view s, const char delim,
+           std::vector<std::string_view> &elems) {
+    thread_local std::vector<uint32_t> pos;
+    pos.clear();
+    indexChars(s.data(), s.size(), delim, delim, pos);
+    size_t start = 0;
+    for (uint32_t end : pos) {
+        elems.push_back(s.substr(start, end - start));
+        start = end + 1;
+    }
+    if (start < s.size()) elems.push_back(s.substr(start));
+}
+
+/**
+ * Compute one 32-bit mask per 32 bytes of data, where bit j of masks[k] is set
+ * if data[32k + j] equals c1 or c2. A partial tail chunk is handled too.
+ */
+static void maskCharsScalar(const char *data, const size_t begin,
+                            const size_t len, const char c1, const char c2,
+                            uint32_t *masks) {
+    for (size_t i = begin; i < len; i += 32) {
+        uint32_t mask = 0;
+        for (size_t j = i; j < std::min(i + 32, len); j++)
+            if (data[j] == c1 || data[j] == c2) mask |= 1u << (j - i);
+        masks[i / 32] = mask;
+    }
+}
+
+#ifdef STRUTILS_X86_DISPATCH
+__attribute__((target("avx2"))) static void maskCharsAVX2(const char *data,
+                                                          const size_t len,
+                                                          const char c1,
+                                                          const char c2,
+                                                          uint32_t *masks) {
+    const __m256i v1 = _mm256_set1_epi8(c1), v2 = _mm256_set1_epi8(c2);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi8(v, v1),
+                                     _mm256_cmpeq_epi8(v, v2));
+        masks[i / 32] = (uint32_t)_mm256_movemask_epi8(eq);
+    }
+    maskCharsScalar(data, i, len, c1, c2, masks);
+}
+
+static void maskCharsSSE2(const char *data, const size_t len, const char c1,
+                          const char c2, uint32_t *masks) {
+    const __m128i v1 = _mm_set1_epi8(c1), v2 = _mm_set1_epi8(c2);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m128i lo = _mm_loadu_si128((const __m128i *)(data + i)),
+                hi = _mm_loadu_si128((const __m128i *)(data + i + 16));
+        uint32_t mlo = _mm_movemask_epi8(_mm_or_si128(
+                     _mm_cmpeq_epi8(lo, v1), _mm_cmpeq_epi8(lo, v2))),
+                 mhi = _mm_movemask_epi8(_mm_or_si128(
+                     _mm_cmpeq_epi8(hi, v1), _mm_cmpeq_epi8(hi, v2)));
+        masks[i / 32] = mlo | mhi << 16;
+    }
+    maskCharsScalar(data, i, len, c1, c2, masks);
+}
+
+static bool hasAVX2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+size_t indexChars(const char *data, const size_t len, const char c1,
+                  const char c2, std::vector<uint32_t> &pos) {
+    // stage 1: bitmasks of matched bytes
+    thread_local std::vector<uint32_t> masks;
+    size_t num_masks = (len + 31) / 32;
+    if (masks.size() < num_masks) masks.resize(num_masks);
+#ifdef STRUTILS_X86_DISPATCH
+    static const bool avx2 = hasAVX2();
+    if (avx2)
+        maskCharsAVX2(data, len, c1, c2, masks.data());
+    else
+        maskCharsSSE2(data, len, c1, c2, masks.data());
+#else
+    maskCharsScalar(data, 0, len, c1, c2, masks.data());
+#endif
+
+    // stage 2: flatten bitmasks into offsets
+    size_t num = 0, old_sz = pos.size();
+    for (size_t k = 0; k < num_masks; k++) num += __builtin_popcount(masks[k]);
+    pos.resize(old_sz + num);
+    uint32_t *out = pos.data() + old_sz;
+    for (size_t k = 0; k < num_masks; k++) {
+        uint32_t mask = masks[k];
+        while (mask != 0) {
+            *out++ = k * 32 + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    return num;
+}
+
 std::string trim_left(const std::string &str) {
     const std::string &pattern = " \f\n\r\t\v";
     return str.substr(str.find_first_not_of(pattern));
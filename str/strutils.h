@@ -1,8 +1,11 @@
 #ifndef __STRUTILS_H__
 #define __STRUTILS_H__
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <vector>
 
 #define FMT_HEADER_ONLY
 #include "../fmt/fmt/format.h"
@@ -66,6 +69,26 @@ void split(const std::string &s, const char delim,
 
 std::vector<std::string> split(const std::string &s, const char delim);
 
+/**
+ * Split a string into views by specified char without copying, following the
+ * same rules as above, i.e., no trailing empty field. The views refer to the
+ * memory of 's'. Delimiters are located by indexChars().
+ */
+void split(std::string_view s, const char delim,
+           std::vector<std::string_view> &elems);
+
+/**
+ * Structural indexing: append to 'pos' the offsets of all bytes in
+ * [data, data + len) that equal c1 or c2, in increasing order, and return the
+ * number of offsets appended. The input is scanned 32 bytes at a time with
+ * AVX2 compare/movemask when the CPU supports it (16 bytes with SSE2
+ * otherwise), and the set bits of each mask are turned into offsets.
+ *
+ * Require: len < 4GB.
+ */
+size_t indexChars(const char *data, const size_t len, const char c1,
+                  const char c2, std::vector<uint32_t> &pos);
+
 std::string trim_left(const std::string &str);
 std::string trim_right(const std::string &str);
 std::string trim(const std::string &str);
@@ -1,9 +1,15 @@
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "../adv/LRUCache.h"
+#include "../adv/clock_cache.h"
+#include "../adv/slab_cache.h"
+#include "../adv/tinylfu_cache.h"
+#include "../os/osutils.h"
 
-int main(int argc, char* argv[]) {
+void test_cache() {
     lru::Cache<std::string, std::string> cache(3);
     cache.insert("hello", "world");
     cache.insert("foo", "bar");
@@ -11,6 +17,171 @@ int main(int argc, char* argv[]) {
     std::cout << "checking refresh : " << cache.get("hello") << std::endl;
     cache.insert("hello1", "world1");
     cache.insert("foo1", "bar1");
+}
+
+/**
+ * Look up keys of a skewed key space by several threads, inserting on misses.
+ */
+template <class C>
+void lookup(C& cache, const char* name, const int threads, const int n) {
+    std::vector<std::thread> workers;
+    std::vector<long> hits(threads, 0);
+    osutils::Timer tm;
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back([&, t]() {
+            uint64_t x = t + 1;
+            int val;
+            for (int i = 0; i < n; i++) {
+                // xorshift; half of the lookups go to 1% of the keys
+                x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+                int key = x % (i % 2 == 0 ? 1000 : 100000);
+                if (cache.tryGet(key, val))
+                    hits[t]++;
+                else
+                    cache.insert(key, key);
+            }
+        });
+    for (auto& w : workers) w.join();
+    long total = 0;
+    for (long h : hits) total += h;
+    std::cout << name << ": " << threads << " threads, hit ratio "
+              << (double)total / threads / n << ", " << tm.seconds() << "s"
+              << std::endl;
+}
+
+void test_sharded() {
+    lru::ShardedCache<int, int> sharded(10000, 100);
+    std::cout << "shards: " << sharded.getShards() << std::endl;
+    sharded.insert(1, 10);
+    int val = 0;
+    std::cout << "get: " << sharded.get(1) << ", tryGet: "
+              << sharded.tryGet(2, val) << ", size: " << sharded.size()
+              << std::endl;
+
+    // shards are capped at the capacity, which they split exactly
+    lru::ShardedCache<int, int> small(5, 0, 64);
+    for (int i = 0; i < 100; i++) small.insert(i, i);
+    std::cout << "small shards: " << small.getShards()
+              << ", size: " << small.size() << std::endl;
+
+    lru::Cache<int, int, std::mutex> single(10000, 100);
+    lookup(single, "Cache", 4, 1000000);
+    sharded.clear();
+    lookup(sharded, "ShardedCache", 4, 1000000);
+}
+
+void test_clock() {
+    lru::ClockCache<int, int> cache(3);
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+    cache.insert(3, 30);
+    int val = 0;
+    cache.tryGet(1, val);  // referenced, so 2 is evicted
+    cache.insert(4, 40);
+    std::cout << "contains 1, 2, 4: " << cache.contains(1)
+              << cache.contains(2) << cache.contains(4)
+              << ", size: " << cache.size() << std::endl;
+
+    // hits must return the value inserted for the key
+    lru::ClockCache<int, long> clock(10000);
+    std::vector<std::thread> workers;
+    std::atomic<long> wrong{0};
+    for (int t = 0; t < 4; t++)
+        workers.emplace_back([&, t]() {
+            long v;
+            for (int i = 0; i < 1000000; i++) {
+                int key = ((long)i * 7919 + t * 31) % 30000;
+                if (!clock.tryGet(key, v))
+                    clock.insert(key, -(long)key);
+                else if (v != -(long)key)
+                    wrong++;
+                if (i % 100 == 0) clock.remove(key + 1);
+            }
+        });
+    for (auto& w : workers) w.join();
+    std::cout << "wrong values: " << wrong << std::endl;
+
+    lru::ClockCache<int, int> single(10000);
+    lookup(single, "ClockCache", 4, 1000000);
+}
+
+void test_slab() {
+    // the same operations on Cache and SlabCache give the same results
+    const int n = 100000;
+    lru::Cache<int, int> cache(n, 0);
+    lru::SlabCache<int, int> slab(n);
+    uint64_t x = 1;
+    int val = 0, diff = 0;
+    osutils::Timer tm;
+    for (int i = 0; i < 5000000; i++) {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        int key = x % (i % 2 == 0 ? 10000 : 1000000);
+        if (x % 10 == 0) {
+            diff += cache.remove(key) != slab.remove(key);
+        } else if (slab.tryGet(key, val)) {
+            diff += !cache.tryGet(key, val) || val != key;
+        } else {
+            diff += cache.tryGet(key, val);
+            cache.insert(key, key);
+            slab.insert(key, key);
+        }
+    }
+    std::cout << "size: " << cache.size() << ", " << slab.size()
+              << ", diff: " << diff << ", " << tm.seconds() << "s"
+              << std::endl;
+    std::cout << "slab: " << (double)slab.getBytes() / slab.size()
+              << " bytes per entry" << std::endl;
+}
+
+/**
+ * Hit ratio of lookups of 1000 hot keys interleaved with scans of keys used
+ * once, inserting on misses.
+ */
+template <class C>
+void scan(C& cache, const char* name) {
+    uint64_t x = 1;
+    long hits = 0, lookups = 0, scanned = 1000000;
+    int val;
+    for (int i = 0; i < 1000000; i++) {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        int key = i % 4 == 0 ? x % 1000 : scanned++;
+        if (cache.tryGet(key, val)) {
+            hits += key < 1000;
+        } else {
+            cache.insert(key, key);
+        }
+        lookups += key < 1000;
+    }
+    std::cout << name << ": hot hit ratio " << (double)hits / lookups
+              << std::endl;
+}
+
+void test_tinylfu() {
+    lru::Cache<int, int> cache(2000, 0);
+    scan(cache, "Cache");
+    lru::TinyLFUCache<int, int> tinylfu(2000);
+    scan(tinylfu, "TinyLFUCache");
+
+    // neighbor lists of various lengths under a budget of 1MB
+    lru::TinyLFUCache<int, std::vector<int>> lists(
+        1 << 20, [](const int&, const std::vector<int>& nbrs) {
+            return nbrs.size() * sizeof(int);
+        });
+    size_t max_weight = 0;
+    for (int i = 0; i < 100000; i++) {
+        lists.insert(i % 5000, std::vector<int>(i % 2000));
+        max_weight = std::max(max_weight, lists.getWeight());
+    }
+    std::cout << "entries: " << lists.size() << ", max weight: " << max_weight
+              << " <= " << lists.getMaxWeight() << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    test_cache();
+    // test_sharded();
+    // test_clock();
+    // test_slab();
+    // test_tinylfu();
 
     return 0;
 }
@@ -144,11 +144,177 @@ void test_nbrs() {
     printf("\n");
 }
 
+void test_sample() {
+    // a random graph with 1000 nodes and 20000 edges
+    rngutils::default_rng rng;
+    std::vector<std::pair<int, int>> edges;
+    for (int i = 0; i < 20000; i++)
+        edges.emplace_back(rng.uniform(0, 999), rng.uniform(0, 999));
+    ioutils::savePrVec(edges, "sample_test.txt");
+
+    auto S = sampleEdges<dir::DGraph>("sample_test.txt", 100, GraphType::MULTI);
+    printf("edge sample: %d nodes, %d edges\n", S.getNodes(), S.getEdges());
+
+    auto I = sampleInducedSubgraph<dir::DGraph>("sample_test.txt", 0.1);
+    printf("induced sample: %d nodes, %d edges\n", I.getNodes(),
+           I.getEdges());
+
+    auto G = loadEdgeList<dir::DGraph>("sample_test.txt");
+    auto F = forestFire(G, 100, 0.7, 0.3);
+    printf("forest fire: %d nodes, %d edges\n", F.getNodes(), F.getEdges());
+}
+
+long fileSize(const char* filename) {
+    FILE* fp = std::fopen(filename, "rb");
+    std::fseek(fp, 0, SEEK_END);
+    long size = std::ftell(fp);
+    std::fclose(fp);
+    return size;
+}
+
+void test_compact() {
+    // a random graph with 10000 nodes and 200000 edges
+    rngutils::default_rng rng;
+    dir::DGraph G;
+    for (int i = 0; i < 200000; i++)
+        G.addEdge(rng.uniform(0, 9999), rng.uniform(0, 9999));
+    G.save("graph_plain.bin");
+    G.save("graph_compact.bin", true);
+    printf("plain: %ld bytes, compact: %ld bytes\n",
+           fileSize("graph_plain.bin"), fileSize("graph_compact.bin"));
+
+    dir::DGraph H;
+    H.load("graph_compact.bin");
+    int diff = H.getNodes() != G.getNodes() || H.getEdges() != G.getEdges();
+    for (auto ei = G.beginEI(); ei != G.endEI(); ++ei)
+        if (!H.isEdge(ei.getSrcID(), ei.getDstID())) diff++;
+    printf("nodes: %d, edges: %d, diff: %d\n", H.getNodes(), H.getEdges(),
+           diff);
+
+    // a truncated record is rejected
+    std::string rec;
+    G.beginNI()->second.encode(rec, 0);
+    dir::Node nd;
+    printf("truncated record rejected: %d\n",
+           nd.decode(rec.data(), rec.data() + rec.size() - 1, 0) == nullptr);
+}
+
+void test_cgraph() {
+    // a random graph with 10000 nodes and 50000 edges
+    rngutils::default_rng rng;
+    std::vector<std::pair<int, int>> edges;
+    for (int i = 0; i < 50000; i++)
+        edges.emplace_back(rng.uniform(0, 9999), rng.uniform(0, 9999));
+    dir::DGraph G;
+    for (auto& pr : edges) G.addEdge(pr.first, pr.second);
+    comp::CGraph C;
+    C.build(edges);
+    printf("nodes: %d, %d, edges: %d, %d, compressed: %lu bytes\n",
+           G.getNodes(), C.getNodes(), G.getEdges(), C.getEdges(),
+           C.getBytes());
+    comp::CGraph D;
+    D.build(G);
+    D.save("cgraph.bin");
+    C.load("cgraph.bin");
+    printf("from DGraph: %d nodes, %d edges\n", C.getNodes(), C.getEdges());
+
+    // streaming from edge files sorted by sources and by destinations
+    edges.clear();
+    for (auto ei = G.beginEI(); ei != G.endEI(); ++ei)
+        edges.emplace_back(ei.getSrcID(), ei.getDstID());
+    std::sort(edges.begin(), edges.end());
+    ioutils::savePrVec(edges, "cgraph_out.txt");
+    std::sort(edges.begin(), edges.end(), [](auto& a, auto& b) {
+        return std::make_pair(a.second, a.first) <
+               std::make_pair(b.second, b.first);
+    });
+    ioutils::savePrVec(edges, "cgraph_in.txt");
+    comp::CGraph S;
+    S.build("cgraph_out.txt", "cgraph_in.txt");
+    int diff = S.getNodes() != C.getNodes() || S.getEdges() != C.getEdges();
+    for (auto ei = G.beginEI(); ei != G.endEI(); ++ei)
+        if (!S.isEdge(ei.getSrcID(), ei.getDstID())) diff++;
+    printf("streamed: %d nodes, %d edges, diff: %d\n", S.getNodes(),
+           S.getEdges(), diff);
+
+    DirBFS<dir::DGraph> bfs_g(G);
+    DirBFS<comp::CGraph> bfs_c(C);
+    bfs_g.doBFS(0, 3);
+    bfs_c.doBFS(0, 3);
+    printf("BFS tree: %d, %d\n", bfs_g.getBFSTreeSize(),
+           bfs_c.getBFSTreeSize());
+    bfs_g.doRevBFS(0, -1, 3);
+    bfs_c.doRevBFS(0, -1, 3);
+    printf("reverse BFS tree: %d, %d\n", bfs_g.getBFSTreeSize(),
+           bfs_c.getBFSTreeSize());
+
+    SCCVisitor<dir::DGraph> scc_g(G);
+    SCCVisitor<comp::CGraph> scc_c(C);
+    scc_g.performDFS();
+    scc_c.performDFS();
+    printf("SCCs: %lu, %lu\n", scc_g.getCCSorted().size(),
+           scc_c.getCCSorted().size());
+
+    HyperANF anf_g, anf_c;
+    anf_g.initBitsCC(G);
+    anf_c.initBitsCC(C);
+    printf("ANF(0): %.2f, %.2f\n", anf_g.estimate(0), anf_c.estimate(0));
+}
+
+void test_defrag() {
+    // a hub with long neighbor lists, which are radix sorted
+    rngutils::default_rng rng;
+    undir::UGraph G;
+    for (int i = 0; i < 100000; i++) {
+        G.addEdgeFast(0, rng.uniform(-50000, 50000));
+        G.addEdgeFast(rng.uniform(1, 1000), rng.uniform(1, 1000));
+    }
+    osutils::Timer tm;
+    G.defrag();
+    printf("defrag: %.3fs\n", tm.seconds());
+    int bad = 0;
+    for (auto it = G.beginNI(); it != G.endNI(); it++) {
+        auto& nd = it->second;
+        for (auto ni = nd.beginNbr(); ni + 1 < nd.endNbr(); ni++)
+            if (*ni >= *(ni + 1)) bad++;
+    }
+    printf("hub degree: %d, unsorted pairs: %d\n", G[0].getDeg(), bad);
+}
+
+void test_load_edges() {
+    // a random edge list with 1M edges, loaded serially and by a pipeline
+    rngutils::default_rng rng;
+    auto pout = ioutils::getIOOut("edges.txt.gz");
+    pout->save("# src\tdst\n");
+    for (int i = 0; i < 1000000; i++)
+        pout->save(fmt::format("{}\t{}\n", rng.uniform(0, 99999),
+                               rng.uniform(0, 99999)));
+    pout->close();
+
+    osutils::Timer tm;
+    auto G = loadEdgeList<dir::DGraph>("edges.txt.gz");
+    printf("serial: %d nodes, %d edges, %.3fs\n", G.getNodes(), G.getEdges(),
+           tm.seconds());
+    tm.tick();
+    auto H = loadEdgeList<dir::DGraph>("edges.txt.gz", GraphType::SIMPLE, 4);
+    printf("pipeline: %d nodes, %d edges, %.3fs\n", H.getNodes(),
+           H.getEdges(), tm.seconds());
+    int diff = 0;
+    for (auto ei = G.beginEI(); ei != G.endEI(); ++ei)
+        if (!H.isEdge(ei.getSrcID(), ei.getDstID())) diff++;
+    printf("diff: %d\n", diff);
+}
+
 int main(int argc, char* argv[]) {
     // test_bgraph();
     // test_nbr_iter();
     // test_subgraph();
     test_nbrs();
+    // test_sample();
+    // test_compact();
+    // test_cgraph();
+    // test_defrag();
+    // test_load_edges();
 
     return 0;
 }
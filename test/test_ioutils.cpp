@@ -7,6 +7,7 @@
 
 #include <cstdio>
 #include "../io/ioutils.h"
+#include "../adv/rngutils.h"
 #include "../os/osutils.h"
 
 void test_null_ptr() {
@@ -40,8 +41,261 @@ void test_tsvparser() {
     printf("\n");
 }
 
+void test_tsv_fields() {
+    auto po = ioutils::getIOOut("tsv_test.txt");
+    po->save("# comment\n1\t2.5\t abc \n");
+    po->save(" -3\t1e3\tdef\r\n");
+    po->close();
+
+    ioutils::TSVParser ss("tsv_test.txt");
+    while (ss.next()) {
+        printf("line %lu: %d fields, int: %d, double: %.2f, str: '%s'\n",
+               ss.getLineNO(), ss.getNumFields(), ss.get<int>(0),
+               ss.get<double>(1), ss.get<std::string>(2).c_str());
+    }
+}
+
+void test_int_columns() {
+    rngutils::default_rng rng;
+    std::vector<std::tuple<int, int, int>> vec;
+    for (int i = 0; i < 2000000; i++)
+        vec.emplace_back(rng.randint(0, 1000000), rng.randint(-100, 100),
+                         rng.randint(0, 1000000));
+    ioutils::saveTupleVec(vec, "cols_test.txt");
+
+    osutils::Timer tm;
+    std::vector<int> c0, c2;
+    ioutils::TSVParser ss("cols_test.txt");
+    while (ss.next()) {
+        c0.push_back(ss.get<int>(0));
+        c2.push_back(ss.get<int>(2));
+    }
+    printf("TSVParser: %.4fs\n", tm.seconds());
+
+    tm.tick();
+    std::vector<std::vector<int>> cols;
+    size_t lines = ioutils::parseIntColumns("cols_test.txt", {2, 0}, cols);
+    printf("parseIntColumns: %.4fs, %lu lines\n", tm.seconds(), lines);
+    printf("match: %d\n", cols[0] == c2 && cols[1] == c0);
+}
+
+void test_long_lines() {
+    // lines much longer than a block, mixed with short ones
+    for (std::string fnm : {"long_test.txt", "long_test.lz"}) {
+        auto po = ioutils::getIOOut(fnm);
+        for (int i = 1; i <= 4; i++) {
+            for (int j = 0; j < i * 50000; j++) po->save(fmt::format("{}\t", j));
+            po->save("end\n1\t2\n");
+        }
+        po->close();
+
+        ioutils::TSVParser ss(fnm);
+        while (ss.next())
+            printf("%s line %lu: %d fields, length %lu, last '%s'\n",
+                   fnm.c_str(), ss.getLineNO(), ss.getNumFields(),
+                   ss.getLine().size(),
+                   ss.get<std::string>(ss.getNumFields() - 1).c_str());
+    }
+}
+
+void test_mmap() {
+    auto po = ioutils::getIOOut("mmap_test.txt");
+    po->save("1\t2\n3\t4\nlast line without newline");
+    po->close();
+    ioutils::getIOOut("mmap_empty.txt")->close();
+
+    ioutils::MmapIn in("mmap_test.txt");
+    printf("size: %lu\n", in.size());
+    std::string_view line;
+    while (in.readLine(line))
+        printf("%lu: '%s'\n", in.tell(), std::string(line).c_str());
+
+    in.seek(2);
+    printf("span: '%s'\n", std::string(in.readSpan(5)).c_str());
+
+    ioutils::MmapIn empty("mmap_empty.txt");
+    printf("empty: size %lu, eof %d\n", empty.size(), empty.eof());
+}
+
+void test_lz4_threads() {
+    rngutils::default_rng rng;
+    std::string text;
+    for (int i = 0; i < 4000000; i++)
+        text += fmt::format("{}\t{}\n", rng.randint(0, 100000), i);
+
+    std::vector<std::string> fnms;
+    for (int threads : {1, 4}) {
+        osutils::Timer tm;
+        std::string fnm = fmt::format("lz4_threads_{}.lz", threads);
+        ioutils::LZ4Out out(fnm.c_str(), false, threads);
+        out.write(text.data(), text.size());
+        out.close();
+        printf("%d threads: %.4fs\n", threads, tm.seconds());
+        fnms.push_back(fnm);
+    }
+
+    // outputs are identical and decompress to the input
+    auto p1 = ioutils::getIOIn(fnms[0]), p4 = ioutils::getIOIn(fnms[1]);
+    std::string s1(text.size() + 1, 0), s4(text.size() + 1, 0);
+    size_t n1 = p1->read(&s1[0], s1.size()), n4 = p4->read(&s4[0], s4.size());
+    s1.resize(n1);
+    s4.resize(n4);
+    printf("identical: %d, match: %d\n", s1 == s4, s1 == text);
+}
+
+void test_read_ahead() {
+    rngutils::default_rng rng;
+    auto po = ioutils::getIOOut("read_ahead.lz");
+    for (int i = 0; i < 4000000; i++)
+        po->save(fmt::format("{}\t{}\n", rng.randint(0, 100000), i));
+    po->close();
+
+    for (int blocks : {0, 4}) {
+        osutils::Timer tm;
+        ioutils::LZ4In in("read_ahead.lz", blocks);
+        long sum = 0, lines = 0;
+        std::string_view line;
+        while (lines < 1000000 && in.readLine(line)) {
+            sum += std::atoi(line.data());
+            lines++;
+        }
+        // a moved reader continues where the other one stopped
+        ioutils::LZ4In rest(std::move(in));
+        while (rest.readLine(line)) {
+            sum += std::atoi(line.data());
+            lines++;
+        }
+        printf("read ahead %d: %ld lines, sum %ld, %.4fs\n", blocks, lines, sum,
+               tm.seconds());
+    }
+}
+
+void test_lz4_seek() {
+    rngutils::default_rng rng;
+    std::string text;
+    for (int i = 0; i < 1000000; i++) text += fmt::format("{}\n", i);
+    {
+        ioutils::LZ4Out out("seek_test.lz");
+        out.write(text.data(), text.size() / 2);
+        out.close();
+        // append to an indexed file extends its index
+        out.open("seek_test.lz", true);
+        out.write(text.data() + text.size() / 2, text.size() - text.size() / 2);
+    }
+
+    ioutils::LZ4In in("seek_test.lz");
+    printf("indexed: %d, blocks: %lu, size: %ld (%lu)\n", in.isIndexed(),
+           in.getBlocks(), in.getSize(), text.size());
+
+    bool ok = true;
+    char buf[32];
+    for (int i = 0; i < 1000; i++) {
+        size_t pos = rng.randint<size_t>(0, text.size() - 32);
+        in.seek(pos);
+        ok &= in.read(buf, 32) == 32 && text.compare(pos, 32, buf, 32) == 0 &&
+              in.tell() == pos + 32;
+    }
+    printf("seek: %d\n", ok);
+
+    std::string all(in.getSize(), 0);
+    in.readBlocks(0, in.getBlocks(), &all[0], 4);
+    printf("parallel decompress: %d\n", all == text);
+
+    long lines = 0, sum = 0;
+    for (int part = 0; part < 7; part++) {
+        ioutils::LZ4In pin("seek_test.lz");
+        pin.seekPart(part, 7);
+        std::string_view line;
+        while (pin.readLine(line)) {
+            sum += std::atol(line.data());
+            lines++;
+        }
+    }
+    printf("7 parts: %ld lines, sum %ld\n", lines, sum);
+}
+
+void test_gzip() {
+    std::string text;
+    for (int i = 0; i < 1000000; i++) text += fmt::format("{}\t{}\n", i, i % 7);
+
+    for (int threads : {1, 4}) {
+        osutils::Timer tm;
+        std::string fnm = fmt::format("gzip_{}.gz", threads);
+        auto po = ioutils::getIOOut(fnm, false, threads);
+        po->write(text.data(), text.size());
+        po->close();
+        printf("%d threads: %.4fs, ", threads, tm.seconds());
+
+        tm.tick();
+        auto pi = ioutils::getIOIn(fnm);
+        std::string out(text.size() + 1, 0);
+        out.resize(pi->read(&out[0], out.size()));
+        printf("read %.4fs, match: %d\n", tm.seconds(), out == text);
+    }
+
+    // zero padding after the last member is ignored
+    FILE* fp = std::fopen("gzip_1.gz", "ab");
+    char zeros[512] = {0};
+    std::fwrite(zeros, 1, sizeof(zeros), fp);
+    std::fclose(fp);
+    auto pi = ioutils::getIOIn("gzip_1.gz");
+    std::string out(text.size() + 1, 0);
+    out.resize(pi->read(&out[0], out.size()));
+    printf("padded, match: %d\n", out == text);
+}
+
+void test_zstd() {
+    rngutils::default_rng rng;
+    std::string text;
+    for (int i = 0; i < 1000000; i++)
+        text += fmt::format("{}\t{}\n", i, rng.randint(0, 1000));
+
+    for (std::string fnm : {"codec.lz", "codec.gz", "codec.zst"}) {
+        osutils::Timer tm;
+        auto po = ioutils::getIOOut(fnm, false, 2);
+        po->write(text.data(), text.size());
+        po->close();
+        printf("%s: %lu bytes, write %.4fs, ", fnm.c_str(),
+               ioutils::MmapIn(fnm).size(), tm.seconds());
+
+        tm.tick();
+        auto pi = ioutils::getIOIn(fnm);
+        std::string out(text.size() + 1, 0);
+        out.resize(pi->read(&out[0], out.size()));
+        printf("read %.4fs, match: %d\n", tm.seconds(), out == text);
+    }
+}
+
+void test_arrays() {
+    rngutils::default_rng rng;
+    std::vector<double> vec(1000000);
+    for (auto& v : vec) v = rng.uniform();
+    auto po = ioutils::getIOOut("arrays.lz");
+    po->writeArray(vec.data(), vec.size());
+    po->save(vec);
+    po->close();
+
+    // without read-ahead, whole blocks are decompressed into the array
+    std::unique_ptr<ioutils::IOIn> pi =
+        std::make_unique<ioutils::LZ4In>("arrays.lz");
+    std::vector<double> arr(vec.size()), loaded;
+    size_t n = pi->readArray(arr.data(), arr.size());
+    pi->load(loaded);
+    printf("read %lu, match: %d %d\n", n, arr == vec, loaded == vec);
+}
+
 int main(int argc, char* argv[]) {
     // test_null_ptr();
     test_tsvparser();
+    // test_tsv_fields();
+    // test_int_columns();
+    // test_long_lines();
+    // test_mmap();
+    // test_lz4_threads();
+    // test_read_ahead();
+    // test_lz4_seek();
+    // test_gzip();
+    // test_zstd();
+    // test_arrays();
     return 0;
 }
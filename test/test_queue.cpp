@@ -0,0 +1,157 @@
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../adv/synqueue.h"
+#include "../adv/lockfree_queue.h"
+#include "../adv/pipeline.h"
+#include "../os/osutils.h"
+
+/**
+ * Move n ints from producers to consumers through queue Q, and check the sum.
+ */
+template <class Q>
+void transfer(Q& queue, const char* name, const int producers,
+              const int consumers, const long n) {
+    std::vector<std::thread> threads;
+    std::vector<long> sums(consumers, 0);
+    osutils::Timer tm;
+    for (int p = 0; p < producers; p++)
+        threads.emplace_back([&, p]() {
+            for (long i = p; i < n; i += producers) queue.push(i);
+        });
+    for (int c = 0; c < consumers; c++)
+        threads.emplace_back([&, c]() {
+            long item = 0;
+            for (long i = c; i < n; i += consumers) {
+                queue.pop(item);
+                sums[c] += item;
+            }
+        });
+    for (auto& t : threads) t.join();
+    long sum = 0;
+    for (long s : sums) sum += s;
+    printf("%s: %d -> %d, sum %s, %.3fs\n", name, producers, consumers,
+           sum == n * (n - 1) / 2 ? "ok" : "wrong", tm.seconds());
+}
+
+void test_lockfree_queues() {
+    const long n = 1000000;
+    syn::SynQueue<long> sq(1024);
+    transfer(sq, "SynQueue", 2, 2, n);
+    syn::MPMCQueue<long> mq(1024);
+    transfer(mq, "MPMCQueue", 2, 2, n);
+    syn::SPSCQueue<long> spsc(1024);
+    transfer(spsc, "SPSCQueue", 1, 1, n);
+
+    // batches
+    std::thread producer([&]() {
+        std::vector<long> batch(100);
+        for (long i = 0; i < n; i += 100) {
+            for (int j = 0; j < 100; j++) batch[j] = i + j;
+            mq.pushN(batch.data(), batch.size());
+        }
+    });
+    long sum = 0, got = 0, buf[64];
+    while (got < n) {
+        size_t k = mq.popN(buf, 64);
+        for (size_t j = 0; j < k; j++) sum += buf[j];
+        got += k;
+    }
+    producer.join();
+    printf("MPMCQueue batches: sum %s\n",
+           sum == n * (n - 1) / 2 ? "ok" : "wrong");
+}
+
+void test_synqueue() {
+    // two stages: producer -> mod 7 -> sum, moving batches, closed at end
+    syn::SynQueue<long> q1(16), q2(16);
+    std::thread producer([&]() {
+        std::vector<long> batch;
+        for (long i = 0; i < 100000; i++) {
+            batch.push_back(i);
+            if (batch.size() == 256) q1.pushBatch(batch);
+        }
+        q1.pushBatch(batch);
+        q1.close();
+    });
+    std::thread worker([&]() {
+        std::vector<long> in, out;
+        while (q1.popBatch(in)) {
+            for (long x : in) out.push_back(x % 7);
+            in.clear();
+            q2.pushBatch(out);
+        }
+        q2.close();
+    });
+    long sum = 0, item;
+    size_t peak = 0;
+    while (q2.pop(item)) {
+        sum += item;
+        peak = std::max(peak, q2.getSize());
+    }
+    producer.join();
+    worker.join();
+    printf("sum: %ld, closed: %d, peak size: %zu (capacity 16)\n", sum,
+           q2.isClosed(), peak);
+
+    // timeouts
+    syn::SynQueue<int> q(1);
+    int x;
+    printf("pop timeout: %d\n", q.pop(x, std::chrono::milliseconds(10)));
+    bool pushed = q.tryPush(1);
+    printf("push: %d, push timeout: %d\n", pushed,
+           q.push(2, std::chrono::milliseconds(10)));
+}
+
+void test_pipeline() {
+    // numbers -> squares by 4 workers, in order -> check order and sum
+    long n = 0, sum = 0, prev = -1, unordered = 0;
+    syn::Pipeline pipe(8);
+    pipe.source<long>("numbers",
+                      [&](long& x) {
+                          x = n++;
+                          return x < 100000;
+                      })
+        .then(
+            "square", 4, [](long x) { return x * x; }, true)
+        .sink("sum", [&](long sq) {
+            if (sq <= prev) unordered++;
+            prev = sq;
+            sum += sq;
+        });
+    pipe.wait();
+    printf("sum: %ld, unordered: %ld\n", sum, unordered);
+    pipe.printStats();
+
+    // an exception in a stage stops the pipeline and is rethrown by wait()
+    syn::Pipeline bad(8);
+    long m = 0;
+    bad.source<long>("numbers",
+                     [&](long& x) {
+                         x = m++;
+                         return true;
+                     })
+        .then(
+            "check", 4,
+            [](long x) {
+                if (x == 500) throw std::invalid_argument("bad item");
+                return x;
+            },
+            true)
+        .sink("drop", [](long) {});
+    try {
+        bad.wait();
+    } catch (const std::exception& e) {
+        printf("caught: %s\n", e.what());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    test_lockfree_queues();
+    // test_synqueue();
+    // test_pipeline();
+
+    return 0;
+}
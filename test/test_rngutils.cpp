@@ -5,7 +5,9 @@
 #include <map>
 
 #include "../adv/rngutils.h"
+#include "../adv/bulk_rng.h"
 #include "../io/ioutils.h"
+#include "../os/osutils.h"
 
 using namespace rngutils;
 
@@ -59,10 +61,76 @@ void test_choose() {
     ioutils::printVec(vec);
 }
 
+/**
+ * Each element should be chosen with probability num/N.
+ */
+void test_sampling() {
+    rngutils::default_rng rng;
+    const int N = 20, num = 5, trials = 200000;
+    std::vector<int> pop(N);
+    std::iota(pop.begin(), pop.end(), 0);
+
+    std::vector<int> cnt_v(N, 0), cnt_f(N, 0), cnt_r(N, 0);
+    for (int t = 0; t < trials; t++) {
+        for (int v : rngutils::choose(pop, num, rng)) cnt_v[v]++;
+        for (int v : rngutils::chooseFloyd(pop, num, rng)) cnt_f[v]++;
+        rngutils::Reservoir<int> rsv(num, rng);
+        for (int v : pop) {
+            if (rsv.wanted())
+                rsv.add(v);
+            else
+                rsv.skip();
+        }
+        for (int v : rsv.getSamples()) cnt_r[v]++;
+    }
+    printf("expected: %.4f\n", (double)num / N);
+    printf("vitter   floyd   reservoir\n");
+    for (int i = 0; i < N; i++)
+        printf("%.4f  %.4f  %.4f\n", (double)cnt_v[i] / trials,
+               (double)cnt_f[i] / trials, (double)cnt_r[i] / trials);
+
+    // a tiny sample from a huge population
+    osutils::Timer tm;
+    auto idx = rngutils::sampleVitter(1000000000, 10, rng);
+    printf("10 of 1e9 in %.2e s:", tm.seconds());
+    for (auto i : idx) printf(" %lu", i);
+    printf("\n");
+}
+
+void test_bulk() {
+    const size_t n = 10000000;
+    std::vector<uint64_t> ints(n);
+    std::vector<double> dbls(n);
+    osutils::Timer tm;
+
+    rngutils::default_rng rng;
+    tm.tick();
+    rng.generate(ints, 0, UINT64_MAX);
+    printf("default_rng: %.4fs\n", tm.seconds());
+
+    rngutils::bulk_rng brng;
+    tm.tick();
+    brng.fill(ints.data(), n);
+    printf("bulk_rng: %.4fs\n", tm.seconds());
+
+    brng.fill(dbls.data(), n);
+    double sum = std::accumulate(dbls.begin(), dbls.end(), 0.0);
+    auto mm = std::minmax_element(dbls.begin(), dbls.end());
+    printf("mean: %.4f, min: %.4f, max: %.4f\n", sum / n, *mm.first,
+           *mm.second);
+
+    // bulk_rng as the engine of random_generator
+    rngutils::random_generator<rngutils::bulk_rng> grng;
+    for (int i = 0; i < 5; i++) printf("%d ", grng.uniform(1, 6));
+    printf("\n");
+}
+
 int main(int argc, char *argv[]) {
     // test_basic();
     // test_geo();
     test_choose();
+    // test_bulk();
+    // test_sampling();
 
     return 0;
 }
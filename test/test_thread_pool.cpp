@@ -1,7 +1,10 @@
 #include <iostream>
 #include <chrono>
+#include <stdexcept>
 
 #include "../adv/thread_pool.h"
+#include "../adv/work_stealing_pool.h"
+#include "../adv/parallel.h"
 
 class A {
 public:
@@ -34,7 +37,67 @@ public:
 
 void job(const A &a) { std::cout << "in: " << a.vec.size() << std::endl; }
 
+// naive parallel fibonacci: deeply nested fine-grained tasks
+long fib(syn::WorkStealingPool &pool, const int n) {
+    if (n < 20) return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+    auto left = pool.enqueue(fib, std::ref(pool), n - 1);
+    long right = fib(pool, n - 2);
+    return pool.get(left) + right;
+}
+
+void test_work_stealing() {
+    syn::WorkStealingPool pool(4);
+    auto start = std::chrono::steady_clock::now();
+    auto res = pool.enqueue(fib, std::ref(pool), 32);
+    std::cout << "fib(32) = " << pool.get(res) << std::endl;
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100000; i++)
+        results.emplace_back(pool.enqueue([](int x) { return x * x; }, i));
+    long sum = 0;
+    for (auto &&result : results) sum += result.get();
+    std::cout << "sum of squares: " << sum << std::endl;
+    std::chrono::duration<double> secs =
+        std::chrono::steady_clock::now() - start;
+    std::cout << "time: " << secs.count() << "s" << std::endl;
+}
+
+void test_parallel() {
+    syn::ThreadPool pool(4);
+    std::vector<long> vec(1000000);
+    syn::parallel_for(pool, 0, (int)vec.size(), 0, [&](int i) { vec[i] = i; });
+    long sum = syn::parallel_reduce(
+        pool, vec.begin(), vec.end(), 0, 0L,
+        [](std::vector<long>::iterator it) { return *it; },
+        [](long a, long b) { return a + b; });
+    std::cout << "sum: " << sum << std::endl;
+
+    // in-place prefix sums on the default pool
+    syn::parallel_scan(vec.begin(), vec.end(), vec.begin(), 1000, 0L,
+                       [](long a, long b) { return a + b; });
+    std::cout << "prefix sums: " << vec[9] << " " << vec.back() << std::endl;
+
+    // nested loops in pool jobs
+    std::atomic<long> count{0};
+    syn::parallel_for(pool, 0, 100, 1, [&](int) {
+        syn::parallel_for(pool, 0, 1000, 10, [&](int) { count++; });
+    });
+    std::cout << "count: " << count << std::endl;
+
+    // an exception in the body is rethrown once the loop is done
+    try {
+        syn::parallel_for(pool, 0, 1000, 1, [](int i) {
+            if (i == 500) throw std::runtime_error("bad index");
+        });
+    } catch (const std::exception &e) {
+        std::cout << "caught: " << e.what() << std::endl;
+    }
+}
+
 int main(int argc, char *argv[]) {
+    // test_work_stealing();
+    // test_parallel();
+
     syn::ThreadPool pool(2);
     std::vector<std::future<void>> results;
 